@@ -0,0 +1,401 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#define _DEFAULT_SOURCE
+#include "clogo/clogo.h"
+#include "clogo/testfn.h"
+#include "demos.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Best values of the test functions
+#define MAX__rosenbrock_2 (0.0)
+#define MAX__sin_2 (0.9517936893872353)
+
+//Defaults of the command line options
+#define BENCH_MEAN 200
+#define BENCH_WORKERS 8
+
+//Samples every run takes, whatever it found by then, and
+//the number of times each run is repeated to take the one
+//of median time
+#define BENCH_BUDGET 2000
+#define BENCH_REPEATS 5
+
+//Shape of the lognormal latency (sigma of the underlying 
+//normal) and of the heavy-tailed one (Pareto alpha), and 
+//the longest latency either may draw, in means
+#define BENCH_SIGMA 1.0
+#define BENCH_ALPHA 1.5
+#define BENCH_CAP 100.0
+
+//Width of the band along the edges of the box where the
+//boundary latency is slower, and by how much
+#define BENCH_EDGE 0.05
+#define BENCH_SLOW 100.0
+
+//M_PI isn't part of strict C11
+#define BENCH_PI 3.14159265358979323846
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* bench_latency
+*
+* Distribution of the synthetic evaluation time.
+***********************************************************/
+enum bench_latency {
+  BENCH_FIXED,             //always the mean
+  BENCH_LOGNORMAL,         //lognormal around the mean
+  BENCH_PARETO,            //heavy-tailed (Pareto)
+  BENCH_BOUNDARY,          //BENCH_SLOW times the mean near
+                           //the edges of the box, the mean
+                           //elsewhere
+  BENCH_LATENCIES          //number of distributions
+};
+
+/***********************************************************
+* bench_objective
+*
+* A test function and its best value.
+***********************************************************/
+struct bench_objective {
+  const char *name;        //name on the command line
+  double (*fn)(double *);  //test function
+  double optimum;          //best value of fn
+};
+
+
+/*********************************************************************
+* GLOBALS
+*********************************************************************/
+static const char *bench_latency_names[BENCH_LATENCIES] = {
+  "fixed", "lognormal", "pareto", "boundary"
+};
+static const struct bench_objective bench_objectives[] = {
+  {"rosenbrock", &rosenbrock_2, MAX__rosenbrock_2},
+  {"sin", &sin_2, MAX__sin_2}
+};
+
+//Objective being benchmarked, and how its latency is drawn
+static const struct bench_objective *bench_current;
+static enum bench_latency bench_model;
+static double bench_mean = BENCH_MEAN;
+static bool bench_spin = false;
+
+//Total time spent inside the objective by every worker
+static pthread_mutex_t bench_lock = PTHREAD_MUTEX_INITIALIZER;
+static double bench_busy;
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* bench_now
+*
+* Returns the current wall clock time in seconds.
+***********************************************************/
+static double bench_now()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+} /* bench_now() */
+
+/***********************************************************
+* bench_uniform
+*
+* Returns a uniform number in (0, 1) derived from the bits
+* of a point and a salt (splitmix64), so every point always
+* takes the same time, whichever thread evaluates it.
+***********************************************************/
+static double bench_uniform(
+  const double *point,     //point being evaluated
+  uint64_t salt            //distinguishes several draws
+)
+{
+  uint64_t z = salt;
+  for (int i = 0; i < DIM; i++) {
+    uint64_t bits;
+    memcpy(&bits, &point[i], sizeof(bits));
+    z += bits + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+  }
+  return ((z >> 11) + 0.5) / 9007199254740992.0;
+} /* bench_uniform() */
+
+/***********************************************************
+* bench_delay
+*
+* Returns the time an evaluation of the given point takes,
+* in seconds. Every random distribution has the same mean;
+* the boundary one depends on the location only, like a 
+* mesh refined near the boundaries.
+***********************************************************/
+static double bench_delay(
+  const double *point      //point being evaluated
+)
+{
+  double mean = bench_mean * 1e-6;
+  double u = bench_uniform(point, 1);
+  double delay = mean;
+
+  if (bench_model == BENCH_LOGNORMAL) {
+    double z = sqrt(-2.0 * log(u)) * cos(2.0 * BENCH_PI * bench_uniform(point, 2));
+    delay = mean * exp(BENCH_SIGMA * z - BENCH_SIGMA * BENCH_SIGMA / 2.0);
+  } else if (bench_model == BENCH_PARETO) {
+    double scale = mean * (BENCH_ALPHA - 1.0) / BENCH_ALPHA;
+    delay = scale / pow(u, 1.0 / BENCH_ALPHA);
+  } else if (bench_model == BENCH_BOUNDARY) {
+    for (int i = 0; i < DIM; i++) {
+      if (point[i] < BENCH_EDGE || point[i] > 1.0 - BENCH_EDGE) {
+        return BENCH_SLOW * mean;
+      }
+    }
+  }
+  return delay < BENCH_CAP * mean ? delay : BENCH_CAP * mean;
+} /* bench_delay() */
+
+/***********************************************************
+* bench_fn
+*
+* The objective being benchmarked, taking a synthetic time
+* to evaluate: either sleeping, like a remote simulation, 
+* or spinning, like a local computation.
+***********************************************************/
+static double bench_fn(
+  double *i
+)
+{
+  double start = bench_now();
+  double end = start + bench_delay(i);
+  if (bench_spin) {
+    while (bench_now() < end) continue;
+  } else {
+    double left = end - start;
+    struct timespec ts = {
+      .tv_sec = (time_t)left,
+      .tv_nsec = (long)((left - (time_t)left) * 1e9)
+    };
+    nanosleep(&ts, NULL);
+  }
+  double value = (*bench_current->fn)(i);
+
+  pthread_mutex_lock(&bench_lock);
+  bench_busy += bench_now() - start;
+  pthread_mutex_unlock(&bench_lock);
+  return value;
+} /* bench_fn() */
+
+/***********************************************************
+* hmax
+*
+* Function that describes the maximum depth level to 
+* consider given a certain number of function evaluations.
+***********************************************************/
+static double hmax(
+  int64_t n                //current number of function eval
+)
+{
+  return sqrt((double)n);
+} /* hmax() */
+
+/***********************************************************
+* soo_schedule
+*
+* w schedule for the SOO algorithm. Always 1.
+***********************************************************/
+static int soo_schedule(
+  const struct clogo_state *state
+)
+{
+  (void)state;
+  return 1;
+} /* soo_schedule() */
+
+/***********************************************************
+* bench_optimize
+*
+* Optimizes the current objective for BENCH_BUDGET samples,
+* in batches of the given size spread over the given number
+* of workers, BENCH_REPEATS times, and returns the result.
+* The median time the runs took and the time that run 
+* spent in the objective are stored in `elapsed` and 
+* `busy`.
+***********************************************************/
+static struct clogo_result bench_optimize(
+  int batch,               //nodes expanded per depth group
+  int workers,             //number of workers
+  bool ordered,            //true to hand out the longest 
+                           //expected evaluations first
+  double *elapsed,         //output wall clock time
+  double *busy             //output time spent in bench_fn
+)
+{
+  //Never stop at epsilon, so that every run does the same
+  //work and only the time it takes changes.
+  struct clogo_options opt = {
+    .max = BENCH_BUDGET,
+    .k = 3,
+    .fn = &bench_fn,
+    .hmax = &hmax,
+    .w_schedule = &soo_schedule,
+    .init_w = 1,
+    .epsilon = -1.0,
+    .fn_optimum = bench_current->optimum,
+    .batch = batch,
+    .workers = workers,
+    .latency_order = ordered
+  };
+
+  struct clogo_result r;
+  double times[BENCH_REPEATS];
+  double busy_times[BENCH_REPEATS];
+  for (int i = 0; i < BENCH_REPEATS; i++) {
+    bench_busy = 0.0;
+    double start = bench_now();
+    r = clogo_optimize(&opt);
+    times[i] = bench_now() - start;
+    busy_times[i] = bench_busy;
+  }
+
+  //The runs are the same but for their timing, so any of
+  //them stands for the result.
+  int median = 0;
+  for (int i = 0; i < BENCH_REPEATS; i++) {
+    int below = 0;
+    for (int j = 0; j < BENCH_REPEATS; j++) {
+      if (times[j] < times[i] || (times[j] == times[i] && j < i)) below++;
+    }
+    if (below == BENCH_REPEATS / 2) median = i;
+  }
+  *elapsed = times[median];
+  *busy = busy_times[median];
+  return r;
+} /* bench_optimize() */
+
+/***********************************************************
+* bench_run
+*
+* Optimizes the current objective in batches of 
+* `max_workers` nodes spread over 1, 2, 4, ... up to 
+* `max_workers` workers, so that every run samples the 
+* same points, and prints the speedup over a single 
+* worker, how busy the workers were, and the error after
+* BENCH_BUDGET samples. Each run is done again handing out
+* the longest expected evaluations first, and the reduction
+* of the time it took (the sum of the makespans of the 
+* batches) is printed too.
+***********************************************************/
+static void bench_run(
+  int max_workers          //largest number of workers
+)
+{
+  double base_time = 0.0;
+  for (int workers = 1; workers <= max_workers; workers *= 2) {
+    double elapsed, busy, ordered_elapsed, ordered_busy;
+    struct clogo_result r = bench_optimize(max_workers, workers, false, 
+                                           &elapsed, &busy);
+    bench_optimize(max_workers, workers, true, &ordered_elapsed, &ordered_busy);
+    if (workers == 1) base_time = elapsed;
+
+    double capacity = elapsed * workers;
+    printf("%-10s %-10s %7d %8" PRId64 " %8.3fs %7.2fx %10.1f%% %8.3fs %10.2e"
+           " %8.3fs %7.1f%%\n",
+           bench_latency_names[bench_model], bench_current->name, workers,
+           r.samples, elapsed, base_time / elapsed, 
+           100.0 * busy / capacity, capacity - busy,
+           bench_current->optimum - r.value, ordered_elapsed,
+           100.0 * (elapsed - ordered_elapsed) / elapsed);
+  }
+} /* bench_run() */
+
+/***********************************************************
+* main
+*
+* Benchmarks batched optimization of the test functions 
+* under synthetic evaluation latencies:
+*   clbench [--latency fixed|lognormal|pareto|boundary] 
+*           [--mean US]
+*           [--spin] [--workers N] [--fn rosenbrock|sin]
+*   clbench --demos
+* By default every latency and function is benchmarked. 
+* With --demos, the demo of every feature of the library 
+* is run instead.
+***********************************************************/
+int main(
+  int argc,
+  char **argv
+)
+{
+  int max_workers = BENCH_WORKERS;
+  int only_latency = -1;
+  const char *only_fn = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (strcmp(arg, "--spin") == 0) {
+      bench_spin = true;
+      continue;
+    }
+    if (strcmp(arg, "--demos") == 0) {
+      bench_demos();
+      return 0;
+    }
+    if (i + 1 >= argc) {
+      fprintf(stderr, "missing value for %s\n", arg);
+      return 1;
+    }
+    const char *value = argv[++i];
+    if (strcmp(arg, "--mean") == 0) {
+      bench_mean = strtod(value, NULL);
+    } else if (strcmp(arg, "--workers") == 0) {
+      max_workers = atoi(value);
+    } else if (strcmp(arg, "--fn") == 0) {
+      only_fn = value;
+    } else if (strcmp(arg, "--latency") == 0) {
+      for (int l = 0; l < BENCH_LATENCIES; l++) {
+        if (strcmp(value, bench_latency_names[l]) == 0) only_latency = l;
+      }
+      if (only_latency < 0) {
+        fprintf(stderr, "unknown latency %s\n", value);
+        return 1;
+      }
+    } else {
+      fprintf(stderr, "unknown option %s\n", arg);
+      return 1;
+    }
+  }
+
+  printf("%-10s %-10s %7s %8s %9s %8s %11s %9s %10s %9s %8s\n",
+         "latency", "fn", "workers", "samples", "time", "speedup",
+         "utilization", "idle", "error", "ordered", "cut");
+  int objectives = sizeof(bench_objectives) / sizeof(bench_objectives[0]);
+  for (int l = 0; l < BENCH_LATENCIES; l++) {
+    if (only_latency >= 0 && l != only_latency) continue;
+    bench_model = l;
+    for (int f = 0; f < objectives; f++) {
+      bench_current = &bench_objectives[f];
+      if (only_fn != NULL && strcmp(only_fn, bench_current->name) != 0) continue;
+      bench_run(max_workers);
+    }
+  }
+  return 0;
+} /* main() */
@@ -0,0 +1,1358 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#define _DEFAULT_SOURCE
+#include "demos.h"
+#include "clogo/clogo.h"
+#include "clogo/bandit.h"
+#include "clogo/decompose.h"
+#include "clogo/direct.h"
+#include "clogo/embed.h"
+#include "clogo/expr.h"
+#include "clogo/portfolio.h"
+#include "clogo/specialize.h"
+#include "clogo/status.h"
+#include "clogo/testfn.h"
+#include "clogo/topn.h"
+#include "clogo/trace.h"
+#include "clogo/vector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Fancy deferring macro for fancy preprocessor junk
+#define CAT(a, ...) a ## __VA_ARGS__
+#define _FN_MAX(x) CAT(MAX__, x)
+#define FN_MAX _FN_MAX(FN)
+
+//Maximum values of functions provided in this module
+#define MAX__rosenbrock_2 (0.0)
+#define MAX__sin_2 (0.9517936893872353)
+
+//Function to test
+#define FN rosenbrock_2
+
+//Sample budget of the out-of-core storage test, and the 
+//directory its deep levels are kept in
+#define STORAGE_MAX 1000000
+#define STORAGE_PATH "/tmp"
+#define STORAGE_DEPTH 16
+
+//Inputs of the high dimensional embedding test function,
+//and the two of them it actually depends on
+#define EMBED_DIM 100
+#define EMBED_X 3
+#define EMBED_Y 41
+#define EMBED_RESTARTS 4
+
+//Standard deviation of the noise added by noisy_sin_2, and
+//the number of evaluations StoSOO averages per cell
+#define NOISE_SD 0.1
+#define NOISE_K 8
+#define NOISE_RUNS 20
+
+//Radius of the feasible disk around rosenbrock_2's optimum
+//(in its [-5,10] coordinates), and the penalty value given 
+//to points outside of it
+#define FEASIBLE_RADIUS 3.0
+#define INFEASIBLE_VALUE (-1e7)
+
+//Number of integer values each input of fn_integer takes
+#define INTEGER_LEVELS 64
+#define INTEGER_MAX 20000
+
+//Synthetic latency of a single evaluation in the batched 
+//runs (in microseconds), the number of threads evaluating
+//a batch, and the largest batch size tried
+#define BATCH_LATENCY 200
+#define BATCH_WORKERS 8
+#define BATCH_MAX 8
+
+//Number of nodes expanded per step when checking that 
+//batched runs don't depend on the number of workers
+#define DETERMINISM_BATCH 4
+
+//Number of processes of a decomposed optimization
+#define DECOMPOSE_REGIONS 4
+
+//Number of metrics of fn_metrics, number of scalarizations
+//optimized at once, and the budget of each
+#define VECTOR_METRICS 2
+#define VECTOR_WEIGHTS 3
+#define VECTOR_MAX 1000
+
+//Number of points the expression interpreter is timed on, 
+//and rosenbrock_2 written as an expression over [-5,10]
+#define EXPR_BENCH (1 << 20)
+#define EXPR_ROSENBROCK "-(100*(y-x^2)^2+(x^2-1)^2)"
+
+//Budget of the optimizations comparing split dimensions
+#define SPLIT_MAX 20000
+
+//Budget of the optimization whose status page is read 
+//by another process while it runs
+#define STATUS_MAX 20000
+
+//Number of distinct optima of sin_2 reported, how far 
+//apart they must be, and the budget spent looking
+#define TOPN_COUNT 5
+#define TOPN_SEPARATION 0.1
+#define TOPN_MAX 2000
+
+
+/*********************************************************************
+* GLOBALS
+*********************************************************************/
+//Expression timed by display_expr
+static struct clogo_expr expr_objective;
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* gaussian
+*
+* Returns a standard normal random number. Deterministic, 
+* so runs can be compared.
+***********************************************************/
+static double gaussian()
+{
+  static uint64_t s = 1;
+  double u[2];
+  for (int i = 0; i < 2; i++) {
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    u[i] = ((s >> 11) + 0.5) / 9007199254740992.0;
+  }
+  return sqrt(-2.0 * log(u[0])) * cos(2.0 * 3.14159265358979323846 * u[1]);
+} /* gaussian() */
+
+/***********************************************************
+* noisy_sin_2
+*
+* sin_2 observed through gaussian noise, like a stochastic
+* simulation.
+***********************************************************/
+static double noisy_sin_2(
+  double *i
+)
+{
+  return sin_2(i) + NOISE_SD * gaussian();
+} /* noisy_sin_2() */
+
+/***********************************************************
+* noisy_sin_2_batch
+*
+* Batch version of noisy_sin_2. A real backend would run 
+* the evaluations in parallel.
+***********************************************************/
+static void noisy_sin_2_batch(
+  double *points,          //points, one after the other
+  int count,               //number of points
+  double *values           //output values
+)
+{
+  for (int i = 0; i < count; i++) values[i] = noisy_sin_2(&points[i*DIM]);
+} /* noisy_sin_2_batch() */
+
+/***********************************************************
+* in_disk
+*
+* Constraint of the feasibility test: a disk of radius 
+* FEASIBLE_RADIUS around the optimum of rosenbrock_2.
+***********************************************************/
+static bool in_disk(
+  double *i
+)
+{
+  double x = -5.0 + i[0] * 15.0 - 1.0;
+  double y = -5.0 + i[1] * 15.0 - 1.0;
+  return x*x + y*y <= FEASIBLE_RADIUS * FEASIBLE_RADIUS;
+} /* in_disk() */
+
+/***********************************************************
+* in_disk_batch
+*
+* Batch version of in_disk.
+***********************************************************/
+static void in_disk_batch(
+  double *points,          //points, one after the other
+  int count,               //number of points
+  bool *out                //output feasibility
+)
+{
+  for (int i = 0; i < count; i++) out[i] = in_disk(&points[i*DIM]);
+} /* in_disk_batch() */
+
+/***********************************************************
+* fn_embedded
+*
+* FN hidden in a EMBED_DIM dimensional input space: only
+* inputs EMBED_X and EMBED_Y matter.
+***********************************************************/
+static double fn_embedded(
+  double *i
+)
+{
+  double x[DIM] = {i[EMBED_X], i[EMBED_Y]};
+  return FN(x);
+} /* fn_embedded() */
+
+/***********************************************************
+* fn_coarse
+*
+* Coarse version of the function being tested, as if 
+* evaluated on a grid of resolution 1/32. Stands in for a
+* cheap, low resolution simulation.
+***********************************************************/
+static double fn_coarse(
+  double *i
+) 
+{
+  double snapped[DIM];
+  for (int d = 0; d < DIM; d++) {
+    snapped[d] = (floor(i[d] * 32.0) + 0.5) / 32.0;
+  }
+  return FN(snapped);
+} /* fn_coarse() */
+
+/***********************************************************
+* fn_integer
+*
+* 2D sin test function of integer inputs: each input picks
+* one of INTEGER_LEVELS evenly spaced values of [0,1].
+***********************************************************/
+static double fn_integer(
+  double *i
+) 
+{
+  double x[DIM];
+  for (int d = 0; d < DIM; d++) {
+    double level = floor(i[d] * INTEGER_LEVELS);
+    if (level > INTEGER_LEVELS - 1) level = INTEGER_LEVELS - 1;
+    x[d] = level / (INTEGER_LEVELS - 1);
+  }
+  return sin_2(x);
+} /* fn_integer() */
+
+/***********************************************************
+* slow_rosenbrock_2
+*
+* rosenbrock_2, taking BATCH_LATENCY microseconds like a 
+* simulation would.
+***********************************************************/
+static double slow_rosenbrock_2(
+  double *i
+) 
+{
+  usleep(BATCH_LATENCY);
+  return rosenbrock_2(i);
+} /* slow_rosenbrock_2() */
+
+/***********************************************************
+* slow_sin_2
+*
+* sin_2, taking BATCH_LATENCY microseconds like a 
+* simulation would.
+***********************************************************/
+static double slow_sin_2(
+  double *i
+) 
+{
+  usleep(BATCH_LATENCY);
+  return sin_2(i);
+} /* slow_sin_2() */
+
+/***********************************************************
+* wall_time
+*
+* Returns the current wall clock time in seconds. Unlike 
+* clock(), this counts time spent waiting for evaluations.
+***********************************************************/
+static double wall_time()
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+} /* wall_time() */
+
+/***********************************************************
+* fn_metrics
+*
+* Vector-valued test objective: rosenbrock_2, and sin_2 
+* scaled to a similar range, as if they were two metrics 
+* of the same simulation.
+***********************************************************/
+static void fn_metrics(
+  double *i,
+  double *metrics
+)
+{
+  metrics[0] = rosenbrock_2(i);
+  metrics[1] = 1000.0 * sin_2(i);
+} /* fn_metrics() */
+
+/***********************************************************
+* hmax
+*
+* Function that describes the maximum depth level to 
+* consider given a certain number of function evaluations.
+***********************************************************/
+static double hmax(
+  int64_t n                //current number of function eval
+)
+{
+  return sqrt((double)n);
+} /* hmax() */
+
+/***********************************************************
+* coarse_until_8
+*
+* Fidelity policy that samples cells shallower than depth 8
+* with the coarsest approximation and everything else with
+* the real objective.
+***********************************************************/
+static int coarse_until_8(
+  int depth                //depth of the cell to sample
+)
+{
+  return depth < 8 ? 0 : 1;
+} /* coarse_until_8() */
+
+/***********************************************************
+* wide_until_2
+*
+* Split schedule that splits cells shallower than depth 2 
+* into 9 children and everything else into 3.
+***********************************************************/
+static int wide_until_2(
+  int depth                //depth of the cell to split
+)
+{
+  return depth < 2 ? 9 : 3;
+} /* wide_until_2() */
+
+/***********************************************************
+* logo_next_w
+*
+* Steps through the LOGO ladder of w values: up if the best
+* value improved, down otherwise.
+***********************************************************/
+static int logo_next_w(
+  int current,             //current w value
+  bool improved            //true if the best value improved
+)
+{
+  static const int w[] = {3, 4, 5, 6, 8, 30};
+  //Find index of current w value
+  int w_cnt = sizeof(w)/sizeof(w[0]);
+  int j = -1;
+  for (int i = 0; i < w_cnt; i++) {
+    if (current == w[i]) {
+      j = i;
+      break;
+    }
+  }
+  assert(j != -1);
+
+  //Decide index of next w value
+  int k = improved ? j+1 : j-1;
+
+  //Clip index
+  if (k < 0) k = 0;
+  else if (k >= w_cnt) k = w_cnt-1;
+
+  return w[k];
+} /* logo_next_w() */
+
+/***********************************************************
+* logo_schedule
+*
+* w schedule for the LOGO algorithm.
+***********************************************************/
+static int logo_schedule(
+  const struct clogo_state *state
+)
+{
+  double new_best = state_best_value(state); 
+  return logo_next_w(state->w, new_best > state->last_best_value);
+} /* logo_schedule() */
+
+/***********************************************************
+* soo_next_w
+*
+* w ladder of the SOO algorithm. Always 1.
+***********************************************************/
+static int soo_next_w(
+  int current,             //current w value
+  bool improved            //true if the best value improved
+)
+{
+  (void)current;
+  (void)improved;
+  return 1;
+} /* soo_next_w() */
+
+/***********************************************************
+* soo_schedule
+*
+* w schedule for the SOO algorithm. Always 1.
+***********************************************************/
+static int soo_schedule(
+  const struct clogo_state *state
+)
+{
+  (void)state; //Don't need to use the parameter if we 
+               //always return the same value.
+  return 1;
+} /* soo_schedule() */
+
+//Specialized copies of the SOO and LOGO paths for FN.
+CLOGO_DEFINE_OPTIMIZER(spec_soo, DIM, 3, FN, hmax, soo_next_w)
+CLOGO_DEFINE_OPTIMIZER(spec_logo, DIM, 3, FN, hmax, logo_next_w)
+
+/***********************************************************
+* display_result
+*
+* Print out debug info about a result structure.
+***********************************************************/
+static void display_result(
+  struct clogo_result *result
+)
+{
+  printf("samples: %" PRId64 "\t cost: %.1f\t estimates: %" PRId64 "\t"
+         " error: %e\t "
+         "point: %f/%f\n",
+         result->samples, result->cost, result->estimates,
+         FN_MAX - result->value,
+         result->point[0], result->point[1]);
+} /* display_result() */
+
+/***********************************************************
+* test_soo
+*
+* Run the optimization using SOO-like settings.
+***********************************************************/
+static struct clogo_options test_soo()
+{
+  struct clogo_options opt = { 
+    .max = 4000,
+    .k = 3,
+    .fn = &FN,
+    .hmax = &hmax,
+    .w_schedule = soo_schedule,
+    .init_w = 1,
+    .epsilon = 1e-4,
+    .fn_optimum = FN_MAX,
+  };
+  return opt;
+} /* test_soo() */
+
+/***********************************************************
+* test_logo
+*
+* Run the optimization using LOGO-like settings.
+***********************************************************/
+static struct clogo_options test_logo()
+{
+  struct clogo_options opt = { 
+    .max = 4000,
+    .k = 3,
+    .fn = &FN,
+    .hmax = &hmax,
+    .w_schedule = logo_schedule,
+    .init_w = 3,
+    .epsilon = 1e-4,
+    .fn_optimum = FN_MAX,
+  };
+  return opt;
+} /* test_logo() */
+
+/***********************************************************
+* test_bamsoo
+*
+* Run the optimization using SOO-like settings, skipping
+* samples a Lipschitz surrogate shows aren't promising.
+***********************************************************/
+static struct clogo_options test_bamsoo()
+{
+  struct clogo_options opt = test_soo();
+  opt.surrogate = 1.0;
+  return opt;
+} /* test_bamsoo() */
+
+/***********************************************************
+* test_multifidelity
+*
+* Run the optimization using SOO-like settings, ranking
+* shallow cells with a cheap approximation of the function.
+***********************************************************/
+static struct clogo_options test_multifidelity()
+{
+  static const struct clogo_fidelity fidelities[] = {
+    { .fn = &fn_coarse, .cost = 0.1 },
+  };
+  struct clogo_options opt = test_soo();
+  opt.fidelities = fidelities;
+  opt.fidelity_count = 1;
+  opt.fidelity_policy = &coarse_until_8;
+  return opt;
+} /* test_multifidelity() */
+
+/***********************************************************
+* test_hybrid
+*
+* Run the optimization using SOO-like settings, switching
+* to a local Nelder-Mead search once the best cell is deep.
+***********************************************************/
+static struct clogo_options test_hybrid()
+{
+  struct clogo_options opt = test_soo();
+  opt.local_depth = 10;
+  opt.local_max = 100;
+  return opt;
+} /* test_hybrid() */
+
+/***********************************************************
+* test_lazy
+*
+* Run the optimization using SOO-like settings, deferring
+* the sampling of children until they could be selected.
+***********************************************************/
+static struct clogo_options test_lazy()
+{
+  struct clogo_options opt = test_soo();
+  opt.lazy = true;
+  return opt;
+} /* test_lazy() */
+
+/***********************************************************
+* test_stosoo
+*
+* Run the optimization of noisy_sin_2 using SOO-like 
+* settings, averaging NOISE_K evaluations per cell.
+***********************************************************/
+static struct clogo_options test_stosoo()
+{
+  struct clogo_options opt = test_soo();
+  opt.fn = &noisy_sin_2;
+  opt.fn_batch = &noisy_sin_2_batch;
+  opt.fn_optimum = INFINITY;  //Run until max
+  opt.noise_k = NOISE_K;
+  return opt;
+} /* test_stosoo() */
+
+/***********************************************************
+* display_noisy
+*
+* Run plain SOO and StoSOO on noisy_sin_2 with the same 
+* budget, and print the mean noise-free error of what each
+* of them found over NOISE_RUNS runs.
+***********************************************************/
+static void display_noisy()
+{
+  struct clogo_options noisy = test_stosoo();
+  struct clogo_options plain = test_soo();
+  plain.fn = noisy.fn;
+  plain.fn_optimum = INFINITY;
+
+  double plain_error = 0.0, noisy_error = 0.0;
+  for (int i = 0; i < NOISE_RUNS; i++) {
+    struct clogo_result a = clogo_optimize(&plain);
+    struct clogo_result b = clogo_optimize(&noisy);
+    plain_error += MAX__sin_2 - sin_2(a.point);
+    noisy_error += MAX__sin_2 - sin_2(b.point);
+  }
+  printf("stosoo: mean true error %f vs %f over %d runs of %" PRId64 
+         " samples\n",
+         noisy_error / NOISE_RUNS, plain_error / NOISE_RUNS,
+         NOISE_RUNS, noisy.max);
+} /* display_noisy() */
+
+/***********************************************************
+* test_feasible
+*
+* Run the optimization using SOO-like settings, with the 
+* in_disk constraint checked before every sample.
+***********************************************************/
+static struct clogo_options test_feasible()
+{
+  struct clogo_options opt = test_soo();
+  opt.feasible_batch = &in_disk_batch;
+  opt.infeasible_value = INFEASIBLE_VALUE;
+  return opt;
+} /* test_feasible() */
+
+/***********************************************************
+* display_feasible
+*
+* Run an optimization with a constraint and print how many 
+* samples it took compared to an unconstrained one, along 
+* with the constraint statistics.
+***********************************************************/
+static void display_feasible()
+{
+  struct clogo_options base = test_soo();
+  struct clogo_options opt = test_feasible();
+  struct clogo_result a = clogo_optimize(&base);
+  struct clogo_result r = clogo_optimize(&opt);
+  int64_t checked = r.feasible + r.infeasible;
+  printf("feasible: %" PRId64 " samples vs %" PRId64 "\t %" PRId64 
+         " of %" PRId64 " checked points feasible (%.1f%%)\t"
+         " error: %e\n",
+         r.samples, a.samples, r.feasible, checked, 
+         100.0 * r.feasible / checked, FN_MAX - r.value);
+} /* display_feasible() */
+
+/***********************************************************
+* test_integer
+*
+* Run the optimization using SOO-like settings, on the 
+* integer inputs of fn_integer.
+***********************************************************/
+static struct clogo_options test_integer()
+{
+  static const double resolution[DIM] = {
+    1.0 / INTEGER_LEVELS, 1.0 / INTEGER_LEVELS
+  };
+  struct clogo_options opt = test_soo();
+  opt.fn = &fn_integer;
+  opt.resolution = resolution;
+
+  //There are few enough points to find the optimum by brute
+  //force.
+  opt.fn_optimum = -INFINITY;
+  for (int x = 0; x < INTEGER_LEVELS; x++) {
+    for (int y = 0; y < INTEGER_LEVELS; y++) {
+      double p[DIM] = {
+        (x + 0.5) / INTEGER_LEVELS, (y + 0.5) / INTEGER_LEVELS
+      };
+      double v = fn_integer(p);
+      if (v > opt.fn_optimum) opt.fn_optimum = v;
+    }
+  }
+  return opt;
+} /* test_integer() */
+
+/***********************************************************
+* display_integer
+*
+* Search the inputs of fn_integer exhaustively with and 
+* without telling the optimizer their resolution, and print
+* how many samples each took.
+***********************************************************/
+static void display_integer()
+{
+  //Don't stop at the optimum: a run that knows the grid 
+  //stops once every point has been evaluated, while the 
+  //other one keeps splitting until the budget is spent.
+  struct clogo_options opt = test_integer();
+  opt.epsilon = -1.0;
+  opt.max = INTEGER_MAX;
+  struct clogo_options base = opt;
+  base.resolution = NULL;
+  struct clogo_result a = clogo_optimize(&base);
+  struct clogo_result r = clogo_optimize(&opt);
+  printf("integer: %" PRId64 " samples vs %" PRId64 " (%" PRId64 
+         " duplicates skipped)\t error: %e\n",
+         r.samples, a.samples, r.duplicates, opt.fn_optimum - r.value);
+} /* display_integer() */
+
+/***********************************************************
+* display_batch
+*
+* Run a SOO-like optimization of a slow objective with 
+* batches of increasing size, and print how many samples 
+* and steps each took along with the wall clock time.
+***********************************************************/
+static void display_batch(
+  const char *name,        //name of the objective
+  double (*fn)(double *),  //objective to optimize
+  double optimum           //best value of fn
+)
+{
+  for (int m = 0; m <= BATCH_MAX; m = m > 0 ? m * 2 : 1) {
+    struct clogo_options opt = test_soo();
+    opt.fn = fn;
+    opt.fn_optimum = optimum;
+    opt.batch = m;
+    opt.workers = BATCH_WORKERS;
+
+    double start = wall_time();
+    struct clogo_state state = clogo_init(&opt);
+    int steps = 0;
+    while (!clogo_done(&state)) {
+      clogo_step(&state);
+      steps++;
+    }
+    struct clogo_result r = clogo_finish(&state);
+    clogo_delete(&state);
+    double elapsed = wall_time() - start;
+
+    printf("batch %s m=%d:\t samples: %" PRId64 "\t steps: %d\t"
+           " time: %.3fs\t error: %e\n",
+           name, m, r.samples, steps, elapsed, optimum - r.value);
+  }
+} /* display_batch() */
+
+/***********************************************************
+* same_contents
+*
+* Returns true if two files hold exactly the same bytes.
+***********************************************************/
+static bool same_contents(
+  FILE *a,
+  FILE *b
+)
+{
+  rewind(a);
+  rewind(b);
+  int c;
+  do {
+    c = fgetc(a);
+    if (c != fgetc(b)) return false;
+  } while (c != EOF);
+  return true;
+} /* same_contents() */
+
+/***********************************************************
+* display_deterministic
+*
+* Run the same batched optimization spread over 1 up to 
+* BATCH_WORKERS workers, recording each run to a trace, and
+* check that every run sampled the same points in the same
+* order and returned the very same result.
+***********************************************************/
+static void display_deterministic(
+  const char *name,        //name of the objective
+  double (*fn)(double *),  //objective to optimize
+  double optimum           //best value of fn
+)
+{
+  FILE *first = NULL;
+  struct clogo_result base;
+  bool same = true;
+  for (int workers = 1; workers <= BATCH_WORKERS; workers *= 2) {
+    struct clogo_options opt = test_soo();
+    opt.fn = fn;
+    opt.fn_optimum = optimum;
+    opt.batch = DETERMINISM_BATCH;
+    opt.workers = workers;
+
+    struct clogo_trace trace;
+    FILE *file = tmpfile();
+    assert(file != NULL);
+    clogo_trace_init(&trace, file, TRACE_RECORD);
+    opt.trace = &trace;
+    struct clogo_result r = clogo_optimize(&opt);
+    fflush(file);
+
+    if (first == NULL) {
+      first = file;
+      base = r;
+      continue;
+    }
+    same = same && same_contents(first, file) &&
+           memcmp(r.point, base.point, sizeof(r.point)) == 0 &&
+           memcmp(&r.value, &base.value, sizeof(r.value)) == 0 &&
+           r.samples == base.samples && r.cost == base.cost;
+    fclose(file);
+  }
+  fclose(first);
+
+  printf("deterministic %s m=%d:\t workers 1-%d sample and return the"
+         " same: %s\n", name, DETERMINISM_BATCH, BATCH_WORKERS,
+         same ? "yes" : "no");
+  assert(same);
+} /* display_deterministic() */
+
+/***********************************************************
+* display_decompose
+*
+* Run a SOO-like optimization of a slow objective in a 
+* single process, then split over DECOMPOSE_REGIONS 
+* processes with and without rebalancing, and print how 
+* many samples and how much time each took.
+***********************************************************/
+static void display_decompose()
+{
+  struct clogo_options opt = test_soo();
+  opt.fn = &slow_rosenbrock_2;
+  struct clogo_result results[DECOMPOSE_REGIONS];
+
+  double start = wall_time();
+  struct clogo_result single = clogo_optimize(&opt);
+  double single_time = wall_time() - start;
+  printf("decompose single:\t samples: %" PRId64 "\t time: %.3fs\t"
+         " error: %e\n",
+         single.samples, single_time, FN_MAX - single.value);
+
+  for (int rebalance = 0; rebalance <= 1; rebalance++) {
+    start = wall_time();
+    struct clogo_result r = clogo_decompose(&opt, DECOMPOSE_REGIONS, rebalance, results);
+    double elapsed = wall_time() - start;
+    printf("decompose %d%s:\t samples: %" PRId64 "\t time: %.3fs\t"
+           " error: %e\t regions:",
+           DECOMPOSE_REGIONS, rebalance ? " rebalanced" : "", r.samples, 
+           elapsed, FN_MAX - r.value);
+    for (int i = 0; i < DECOMPOSE_REGIONS; i++) {
+      printf(" %" PRId64, results[i].samples);
+    }
+    printf("\n");
+  }
+} /* display_decompose() */
+
+/***********************************************************
+* display_vector
+*
+* Optimize several scalarizations of fn_metrics at once, 
+* and print how many simulations that took compared to 
+* optimizing each on its own.
+***********************************************************/
+static void display_vector()
+{
+  static const double weights[VECTOR_WEIGHTS * VECTOR_METRICS] = {
+    1.0, 0.0,
+    0.0, 1.0,
+    0.5, 0.5
+  };
+  struct clogo_options opt = test_soo();
+  opt.fn = NULL;
+  opt.fn_vector = &fn_metrics;
+  opt.metric_count = VECTOR_METRICS;
+  opt.fn_optimum = INFINITY;
+  opt.max = VECTOR_MAX;
+
+  struct clogo_result results[VECTOR_WEIGHTS];
+  int64_t simulated = clogo_vector_optimize(&opt, weights, VECTOR_WEIGHTS, results);
+  int64_t separate = 0;
+  for (int i = 0; i < VECTOR_WEIGHTS; i++) separate += results[i].samples;
+  printf("vector: %" PRId64 " simulations vs %" PRId64 " (%.1f%% saved)\t values:",
+         simulated, separate, 100.0 * (separate - simulated) / separate);
+  for (int i = 0; i < VECTOR_WEIGHTS; i++) printf(" %f", results[i].value);
+  printf("\n");
+} /* display_vector() */
+
+/***********************************************************
+* display_top_n
+*
+* Spend a fixed budget on sin_2, which has many local 
+* optima, and print the best few well-separated ones.
+***********************************************************/
+static void display_top_n()
+{
+  struct clogo_options opt = test_soo();
+  opt.fn = &sin_2;
+  opt.fn_optimum = MAX__sin_2;
+  opt.epsilon = -1.0;
+  opt.max = TOPN_MAX;
+
+  struct clogo_state state = clogo_init(&opt);
+  while (!clogo_done(&state)) clogo_step(&state);
+
+  struct clogo_optimum top[TOPN_COUNT];
+  int found = clogo_top_n(&state, TOPN_COUNT, TOPN_SEPARATION, top);
+  printf("top %d:", found);
+  for (int i = 0; i < found; i++) {
+    printf("\t (%.3f, %.3f) = %f", top[i].point[0], top[i].point[1], top[i].value);
+  }
+  printf("\n");
+  clogo_delete(&state);
+} /* display_top_n() */
+
+/***********************************************************
+* display_status
+*
+* Publish the status of a long optimization while a child
+* process keeps reading it, and print how many snapshots 
+* the child read and whether any of them was torn: every
+* sample costs exactly 1 here, so a consistent snapshot's
+* cost is its number of samples.
+***********************************************************/
+static void display_status()
+{
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/clogo-status-%d", (int)getpid());
+  struct clogo_options opt = test_soo();
+  opt.status_path = path;
+  opt.epsilon = -1.0;
+  opt.max = STATUS_MAX;
+
+  //The page is published as soon as the state exists.
+  struct clogo_state state = clogo_init(&opt);
+  int fds[2];
+  int err = pipe(fds);
+  assert(err == 0);
+  (void)err;
+
+  pid_t pid = fork();
+  assert(pid != -1);
+  if (pid == 0) {
+    const struct clogo_status_page *page = clogo_status_map(path);
+    int64_t counts[2] = {0, 0};
+    struct clogo_status s = {.done = false};
+    while (page != NULL && !s.done) {
+      clogo_status_read(page, &s);
+      counts[0]++;
+      if (s.cost != (double)s.samples) counts[1]++;
+    }
+    ssize_t written = write(fds[1], counts, sizeof(counts));
+    _exit(written == sizeof(counts) ? 0 : 1);
+  }
+
+  while (!clogo_done(&state)) clogo_step(&state);
+  clogo_delete(&state);
+
+  int64_t counts[2] = {0, 0};
+  ssize_t got = read(fds[0], counts, sizeof(counts));
+  waitpid(pid, NULL, 0);
+  close(fds[0]);
+  close(fds[1]);
+  unlink(path);
+  printf("status: %" PRId64 " snapshots read while running, %" PRId64 " torn\n",
+         got == sizeof(counts) ? counts[0] : 0, counts[1]);
+} /* display_status() */
+
+/***********************************************************
+* display_direct
+*
+* Optimize the given objective with SOO's depth groups and
+* with DIRECT's potentially optimal cells (also with cells
+* split adaptively), and print how many samples each took.
+***********************************************************/
+static void display_direct(
+  const char *name,        //name of the objective
+  double (*fn)(double *),  //objective to optimize
+  double optimum           //best value of fn
+)
+{
+  struct clogo_options opt[] = {test_soo(), test_soo(), test_soo()};
+  const char *names[] = {"soo", "direct", "direct adaptive"};
+  opt[1].select = &clogo_direct_select;
+  opt[2].select = &clogo_direct_select;
+  opt[2].adaptive_split = true;
+
+  printf("selection %s:", name);
+  for (int i = 0; i < 3; i++) {
+    opt[i].fn = fn;
+    opt[i].fn_optimum = optimum;
+    struct clogo_result r = clogo_optimize(&opt[i]);
+    printf("\t %s: %" PRId64 " (%.1e)", names[i], r.samples, optimum - r.value);
+  }
+  printf("\n");
+} /* display_direct() */
+
+/***********************************************************
+* display_split
+*
+* Optimize the given objective splitting cells along their
+* widest dimension, then adaptively, and print how many 
+* samples each took.
+***********************************************************/
+static void display_split(
+  const char *name,        //name of the objective
+  double (*fn)(double *),  //objective to optimize
+  double optimum           //best value of fn
+)
+{
+  printf("split %s:", name);
+  for (int adaptive = 0; adaptive <= 1; adaptive++) {
+    struct clogo_options opt = test_soo();
+    opt.fn = fn;
+    opt.fn_optimum = optimum;
+    opt.max = SPLIT_MAX;
+    opt.adaptive_split = adaptive;
+    struct clogo_result r = clogo_optimize(&opt);
+    printf("\t %s: %" PRId64 " (%.1e)", adaptive ? "adaptive" : "widest",
+           r.samples, optimum - r.value);
+  }
+  printf("\n");
+} /* display_split() */
+
+/***********************************************************
+* display_schedules
+*
+* Optimize the given objective with the SOO, LOGO and 
+* bandit w schedules and print how many samples each took.
+***********************************************************/
+static void display_schedules(
+  const char *name,        //name of the objective
+  double (*fn)(double *),  //objective to optimize
+  double optimum           //best value of fn
+)
+{
+  struct clogo_options opt[] = {test_soo(), test_logo(), test_soo()};
+  const char *names[] = {"soo", "logo", "bandit"};
+  opt[2].w_schedule = &clogo_bandit_schedule;
+
+  printf("schedules %s:", name);
+  for (int i = 0; i < 3; i++) {
+    opt[i].fn = fn;
+    opt[i].fn_optimum = optimum;
+    struct clogo_result r = clogo_optimize(&opt[i]);
+    printf("\t %s: %" PRId64 " (%.1e)", names[i], r.samples, optimum - r.value);
+  }
+  printf("\n");
+} /* display_schedules() */
+
+/***********************************************************
+* display_k_schedule
+*
+* Optimize a slow objective in batches, splitting every 
+* cell into 3 and then splitting shallow cells wider, and 
+* print the samples, steps and wall clock time of each.
+***********************************************************/
+static void display_k_schedule(
+  const char *name,        //name of the objective
+  double (*fn)(double *),  //objective to optimize
+  double optimum           //best value of fn
+)
+{
+  for (int wide = 0; wide <= 1; wide++) {
+    struct clogo_options opt = test_soo();
+    opt.fn = fn;
+    opt.fn_optimum = optimum;
+    opt.batch = 1;
+    opt.workers = BATCH_WORKERS;
+    if (wide) opt.k_schedule = &wide_until_2;
+
+    double start = wall_time();
+    struct clogo_state state = clogo_init(&opt);
+    int steps = 0;
+    while (!clogo_done(&state)) {
+      clogo_step(&state);
+      steps++;
+    }
+    struct clogo_result r = clogo_finish(&state);
+    clogo_delete(&state);
+    double elapsed = wall_time() - start;
+
+    printf("k schedule %s %s:\t samples: %" PRId64 "\t steps: %d\t"
+           " time: %.3fs\t error: %e\n",
+           name, wide ? "9,9,3..." : "3", r.samples, steps, elapsed, 
+           optimum - r.value);
+  }
+} /* display_k_schedule() */
+
+/***********************************************************
+* display_expr
+*
+* Time rosenbrock_2 compiled from an expression against the
+* native function, over the same points.
+***********************************************************/
+static void display_expr()
+{
+  char error[128];
+  bool ok = clogo_expr_parse(&expr_objective, EXPR_ROSENBROCK, error, sizeof(error));
+  assert(ok);
+  (void)ok;
+  for (int d = 0; d < DIM; d++) {
+    expr_objective.lo[d] = -5.0;
+    expr_objective.hi[d] = 10.0;
+  }
+
+  double *points = malloc(sizeof(*points) * DIM * EXPR_BENCH);
+  double *values = malloc(sizeof(*values) * EXPR_BENCH);
+  for (int i = 0; i < EXPR_BENCH * DIM; i++) {
+    points[i] = (double)((int64_t)i * 7919 % EXPR_BENCH) / EXPR_BENCH;
+  }
+
+  clock_t start = clock();
+  double native_sum = 0.0;
+  for (int i = 0; i < EXPR_BENCH; i++) native_sum += rosenbrock_2(&points[i * DIM]);
+  double native_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  //Touch the output first, so its page faults aren't timed
+  //along with the interpreter.
+  memset(values, 0, sizeof(*values) * EXPR_BENCH);
+  start = clock();
+  clogo_expr_eval(&expr_objective, points, EXPR_BENCH, values);
+  double expr_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+  double expr_sum = 0.0;
+  for (int i = 0; i < EXPR_BENCH; i++) expr_sum += values[i];
+
+  //The optimizer mostly hands over a few points at a time.
+  start = clock();
+  for (int i = 0; i < EXPR_BENCH; i++) {
+    clogo_expr_eval(&expr_objective, &points[i * DIM], 1, &values[i]);
+  }
+  double single_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("expr: %.1f (%.1f one point at a time) vs %.1f Mevals/s native "
+         "(%d instructions)\t same values: %s\n",
+         EXPR_BENCH / expr_time * 1e-6, EXPR_BENCH / single_time * 1e-6,
+         EXPR_BENCH / native_time * 1e-6, expr_objective.count,
+         fabs(expr_sum - native_sum) <= 1e-9 * fabs(native_sum) ? "yes" : "no");
+
+  free(values);
+  free(points);
+  clogo_expr_delete(&expr_objective);
+} /* display_expr() */
+
+/***********************************************************
+* display_savings
+*
+* Run two optimizations to completion and print how many 
+* samples the second one saved over the first.
+***********************************************************/
+static void display_savings(
+  const char *name,        //name of the second optimization
+  struct clogo_options base,
+                           //reference optimization
+  struct clogo_options other
+                           //optimization to compare
+)
+{
+  struct clogo_result a = clogo_optimize(&base);
+  struct clogo_result b = clogo_optimize(&other);
+  printf("%s: %" PRId64 " samples vs %" PRId64 " (%.1f%% saved)\t"
+         " error: %e\n",
+         name, b.samples, a.samples,
+         100.0 * (a.samples - b.samples) / a.samples,
+         FN_MAX - b.value);
+} /* display_savings() */
+
+/***********************************************************
+* display_fidelities
+*
+* Run an optimization to completion and print how much it
+* cost compared to a reference optimization, along with how
+* many samples were taken at each fidelity level.
+***********************************************************/
+static void display_fidelities(
+  const char *name,        //name of the second optimization
+  struct clogo_options base,
+                           //reference optimization
+  struct clogo_options other
+                           //optimization to compare
+)
+{
+  struct clogo_result a = clogo_optimize(&base);
+
+  struct clogo_state state = clogo_init(&other);
+  while (!clogo_done(&state)) clogo_step(&state);
+  struct clogo_result b = clogo_finish(&state);
+
+  printf("%s: %.1f cost vs %.1f (%.1f%% saved)\t error: %e\t levels:",
+         name, b.cost, a.cost, 100.0 * (a.cost - b.cost) / a.cost,
+         FN_MAX - b.value);
+  for (int i = 0; i <= other.fidelity_count; i++) {
+    printf(" %" PRId64, state.fidelity_samples[i]);
+  }
+  printf("\n");
+  clogo_delete(&state);
+} /* display_fidelities() */
+
+/***********************************************************
+* display_replay
+*
+* Record a run to a trace, then replay it without calling 
+* the objective at all, and print how both runs compare.
+***********************************************************/
+static void display_replay(
+  const char *name,        //name of the optimization
+  struct clogo_options opt //optimization to record
+)
+{
+  struct clogo_trace trace;
+  FILE *file = tmpfile();
+  assert(file != NULL);
+
+  clogo_trace_init(&trace, file, TRACE_RECORD);
+  opt.trace = &trace;
+  clock_t start = clock();
+  struct clogo_result a = clogo_optimize(&opt);
+  double record_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  //Replaying doesn't need the objective at all.
+  rewind(file);
+  clogo_trace_init(&trace, file, TRACE_REPLAY);
+  opt.fn = NULL;
+  start = clock();
+  struct clogo_result b = clogo_optimize(&opt);
+  double replay_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%s replay: %" PRId64 "/%" PRId64 " samples, diverged: %s,"
+         " same result: %s\t"
+         "time: %.3fs vs %.3fs\n",
+         name, b.samples, a.samples, trace.first_divergence >= 0 ? "yes" : "no",
+         (a.value == b.value && a.point[0] == b.point[0] &&
+          a.point[1] == b.point[1]) ? "yes" : "no",
+         replay_time, record_time);
+  fclose(file);
+} /* display_replay() */
+
+/***********************************************************
+* display_portfolio
+*
+* Run SOO and LOGO configurations as a portfolio sharing
+* one evaluation table, and print who finished first and
+* how many evaluations the sharing saved.
+***********************************************************/
+static void display_portfolio()
+{
+  static const char *names[] = {"soo k=3", "logo k=3", "soo k=5", "logo k=5"};
+  struct clogo_options members[] = {
+    test_soo(), test_logo(), test_soo(), test_logo()
+  };
+  members[2].k = 5;
+  members[3].k = 5;
+  int count = sizeof(members)/sizeof(members[0]);
+
+  struct clogo_result results[sizeof(members)/sizeof(members[0])];
+  struct clogo_portfolio_result p = clogo_portfolio(members, count, results);
+
+  printf("portfolio: first: %s\t unique evaluations: %ld of %" PRId64
+         " samples\n",
+         names[p.first], p.unique, p.samples);
+  for (int i = 0; i < count; i++) {
+    printf("  %s:\t", names[i]);
+    display_result(&results[i]);
+  }
+} /* display_portfolio() */
+
+/***********************************************************
+* display_embedding
+*
+* Optimize the high dimensional fn_embedded through several
+* random embeddings in parallel and print each outcome.
+***********************************************************/
+static void display_embedding()
+{
+  struct clogo_options opt = test_soo();
+  opt.fn = fn_embedded;
+  opt.embed_dim = EMBED_DIM;
+  opt.embed_seed = 1;
+
+  struct clogo_result results[EMBED_RESTARTS];
+  double points[EMBED_RESTARTS * EMBED_DIM];
+  int best = clogo_embed_restarts(&opt, EMBED_RESTARTS, results, points);
+
+  for (int i = 0; i < EMBED_RESTARTS; i++) {
+    printf("embedding %d%s:\t samples: %" PRId64 "\t error: %f\t"
+           "x%d: %f\t x%d: %f\n",
+           i, i == best ? "*" : " ", results[i].samples, 
+           FN_MAX - results[i].value,
+           EMBED_X, points[i*EMBED_DIM + EMBED_X],
+           EMBED_Y, points[i*EMBED_DIM + EMBED_Y]);
+  }
+} /* display_embedding() */
+
+/***********************************************************
+* display_storage
+*
+* Run a large budget to completion with every node in 
+* memory, then with deep levels kept in memory-mapped files,
+* and print how both runs compare.
+***********************************************************/
+static void display_storage()
+{
+  struct clogo_options opt = test_soo();
+  opt.max = STORAGE_MAX;
+  opt.fn_optimum = INFINITY;  //Run until max
+
+  clock_t start = clock();
+  struct clogo_result a = clogo_optimize(&opt);
+  double memory_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  opt.storage_path = STORAGE_PATH;
+  opt.storage_depth = STORAGE_DEPTH;
+  start = clock();
+  struct clogo_result b = clogo_optimize(&opt);
+  double file_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("storage: %" PRId64 " samples, same result: %s\t"
+         "time: %.3fs vs %.3fs in memory\n",
+         b.samples,
+         (a.value == b.value && a.point[0] == b.point[0] &&
+          a.point[1] == b.point[1]) ? "yes" : "no",
+         file_time, memory_time);
+} /* display_storage() */
+
+/***********************************************************
+* DISPLAY_SPECIALIZED
+*
+* Time the generic and the specialized optimization paths 
+* over many repeated runs of the same problem. A macro 
+* since every specialization has its own result type.
+***********************************************************/
+#define SPEC_RUNS 200
+#define DISPLAY_SPECIALIZED(name, options, spec)                     \
+  do {                                                               \
+    struct clogo_options opt = (options);                            \
+    struct clogo_result a;                                           \
+    struct spec##_result b;                                          \
+                                                                     \
+    clock_t start = clock();                                         \
+    for (int i = 0; i < SPEC_RUNS; i++) a = clogo_optimize(&opt);    \
+    double generic_time = (double)(clock() - start) / CLOCKS_PER_SEC;\
+                                                                     \
+    start = clock();                                                 \
+    for (int i = 0; i < SPEC_RUNS; i++) {                            \
+      b = spec(opt.max, opt.init_w, opt.epsilon, opt.fn_optimum);    \
+    }                                                                \
+    double spec_time = (double)(clock() - start) / CLOCKS_PER_SEC;   \
+                                                                     \
+    printf("%s specialized: %.1fus vs %.1fus per run (%.2fx)\t"      \
+           "samples: %" PRId64 " vs %" PRId64 "\n",                  \
+           name, 1e6 * spec_time / SPEC_RUNS,                        \
+           1e6 * generic_time / SPEC_RUNS,                           \
+           generic_time / spec_time, b.samples, a.samples);          \
+  } while (0)
+
+/***********************************************************
+* bench_demos
+*
+* Runs a demo of every feature of the library on the test
+* functions, and prints how each of them did.
+***********************************************************/
+void bench_demos()
+{
+  display_savings("bamsoo", test_soo(), test_bamsoo());
+  display_savings("hybrid", test_soo(), test_hybrid());
+  display_savings("lazy", test_soo(), test_lazy());
+  display_fidelities("multifidelity", test_soo(), test_multifidelity());
+  display_replay("logo", test_logo());
+  display_portfolio();
+  display_embedding();
+  display_storage();
+  display_noisy();
+  display_feasible();
+  display_integer();
+  display_batch("rosenbrock", &slow_rosenbrock_2, MAX__rosenbrock_2);
+  display_batch("sin", &slow_sin_2, MAX__sin_2);
+  display_deterministic("rosenbrock", &rosenbrock_2, MAX__rosenbrock_2);
+  display_deterministic("sin", &sin_2, MAX__sin_2);
+  display_decompose();
+  display_vector();
+  display_top_n();
+  display_status();
+  display_schedules("rosenbrock", &rosenbrock_2, MAX__rosenbrock_2);
+  display_schedules("sin", &sin_2, MAX__sin_2);
+  display_direct("rosenbrock", &rosenbrock_2, MAX__rosenbrock_2);
+  display_direct("sin", &sin_2, MAX__sin_2);
+  display_split("rosenbrock", &rosenbrock_2, MAX__rosenbrock_2);
+  display_split("rosenbrock stretched", &rosenbrock_stretched_2, MAX__rosenbrock_2);
+  display_split("rosenbrock rotated", &rosenbrock_rotated_2, MAX__rosenbrock_2);
+  display_split("sin", &sin_2, MAX__sin_2);
+  display_split("sin stretched", &sin_stretched_2, MAX__sin_2);
+  display_k_schedule("rosenbrock", &slow_rosenbrock_2, MAX__rosenbrock_2);
+  display_k_schedule("sin", &slow_sin_2, MAX__sin_2);
+  display_expr();
+  DISPLAY_SPECIALIZED("soo", test_soo(), spec_soo);
+  DISPLAY_SPECIALIZED("logo", test_logo(), spec_logo);
+} /* bench_demos() */
@@ -0,0 +1,15 @@
+#pragma once
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* bench_demos
+*
+* Runs a demo of every feature of the library on the test
+* functions, and prints how each of them did. Some of them
+* take a while: a 1M sample run kept partly in /tmp, and 
+* optimizations spread over forked processes.
+***********************************************************/
+void bench_demos();
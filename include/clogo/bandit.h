@@ -0,0 +1,88 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of (w, hmax scale) pairs the bandit schedule picks
+//from.
+#define BANDIT_ARMS 9
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_bandit
+*
+* Statistics of the bandit schedule: how often each arm 
+* was pulled and the rewards it earned. Rewards are the 
+* improvement of the best value per sample of a step, 
+* normalized by the largest one seen so far.
+***********************************************************/
+struct clogo_bandit {
+  int arm;                 //arm used by the current step
+  int64_t pulls[BANDIT_ARMS];
+                           //number of steps of each arm
+  double rewards[BANDIT_ARMS];
+                           //sum of the rewards of each arm
+  int64_t total;           //number of steps rewarded
+  double max_rate;         //largest improvement per sample
+                           //seen so far
+  double best_before;      //best value before the step
+  int64_t samples_before;  //samples before the step
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_bandit_schedule
+*
+* Adaptive w schedule. Each step runs with one of a few 
+* (w, hmax scale) pairs, chosen by UCB1 according to how
+* much each improved the best value per sample so far. 
+* Setting this as the options' w_schedule is all it takes;
+* the arms are picked as the steps are rewarded, and this
+* returns the w of the current one.
+***********************************************************/
+int clogo_bandit_schedule(
+  const struct clogo_state *state
+                           //current optimization state
+);
+
+/***********************************************************
+* bandit_init
+*
+* Sets up the bandit statistics of a new state, if its 
+* options use the bandit schedule, and the first arm.
+***********************************************************/
+void bandit_init(
+  struct clogo_state *state//state to initialize
+);
+
+/***********************************************************
+* bandit_begin
+*
+* Remembers where the step about to run starts from.
+***********************************************************/
+void bandit_begin(
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* bandit_reward
+*
+* Credits the arm of the step that just ran with its 
+* reward, and picks the arm of the next step by UCB1.
+***********************************************************/
+void bandit_reward(
+  struct clogo_state *state//current optimization state
+);
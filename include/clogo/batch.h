@@ -0,0 +1,68 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* batch_map
+*
+* Calls `fn` on `count` inputs of `dim` entries laid out 
+* one after the other, spread over `workers` threads (the
+* calling one included), which take the inputs in the 
+* given order as they become free. `fn` must be thread-
+* safe if `workers` is greater than 1. Each value is 
+* stored at the index of its input and nothing else is 
+* shared, so the outputs don't depend on the number of 
+* workers, the order or the order calls finish in.
+***********************************************************/
+void batch_map(
+  double (*fn)(double *),  //function to call
+  double *inputs,          //inputs of the function
+  int dim,                 //number of entries per input
+  int count,               //number of inputs
+  int workers,             //number of threads to use
+  const int *order,        //order to call fn in (indices
+                           //of inputs); NULL=input order
+  double *values,          //output value of each input
+  double *seconds          //output time fn took on each 
+                           //input; NULL=don't time calls
+);
+
+/***********************************************************
+* batch_queue
+*
+* Adds a child whose sampling was deferred to the batch of
+* the current step.
+***********************************************************/
+void batch_queue(
+  struct node *n,          //deferred child node
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* batch_expand
+*
+* Expands up to `batch` nodes of the depth group between 
+* `h_min` and `h_max`, best first, starting with `first`. 
+* Only nodes better than `bar` (the best node of every 
+* shallower group) are expanded, so that none of them is 
+* dominated by a node that is both larger and better, and
+* a node whose cell touches one already chosen is skipped,
+* so the batch spreads over separate peaks. The children 
+* of all of them are then sampled together.
+* Returns the value of the best child node sampled.
+***********************************************************/
+double batch_expand(
+  struct node *first,      //best node of the group
+  int h_min,               //shallowest depth in the group
+  int h_max,               //deepest depth in the group
+  double bar,              //value to beat
+  struct clogo_state *state//current optimization state
+);
@@ -4,11 +4,19 @@
 * INCLUDES
 *********************************************************************/
 #include <stdbool.h>
+#include <stdint.h>
 
 /*********************************************************************
 * CONSTANTS
 *********************************************************************/
 #define DIM 2
+//Number of most recent slopes the surrogate's Lipschitz 
+//estimate is taken over.
+#define SURROGATE_WINDOW 16
+//Number of nodes in the first and in the largest storage 
+//segment of a depth level.
+#define STORAGE_MIN_SEGMENT 64
+#define STORAGE_MAX_SEGMENT (1 << 20)
 
 
 /*********************************************************************
@@ -16,6 +24,25 @@
 *********************************************************************/
 //Forward-declared types
 struct clogo_state;
+struct clogo_trace;
+struct clogo_table;
+struct clogo_vector_store;
+struct clogo_bandit;
+struct clogo_status_page;
+struct clogo_latency;
+
+/***********************************************************
+* clogo_fidelity
+*
+* A cheaper approximation of the objective function, along 
+* with its cost relative to one evaluation of the objective
+* itself.
+***********************************************************/
+struct clogo_fidelity {
+  double (*fn)(double *);  //approximate function to evaluate
+  double cost;             //cost of one evaluation, relative
+                           //to the full objective (1.0)
+};
 
 /***********************************************************
 * clogo_options
@@ -24,16 +51,131 @@ struct clogo_state;
 * should behave. Never modified by the optimization itself.
 ***********************************************************/
 struct clogo_options {
-  int max;                 //max number of function samples
+  int64_t max;             //max number of function samples
+                           //(counted in full-fidelity cost)
   int k;                   //number of splits per cell
+  int (*k_schedule)(int);  //number of splits of a cell at 
+                           //the given depth (odd); NULL=k
+                           //at every depth
   double (*fn)(double *);  //function to evaluate
-  double (*hmax)(int);     //depth limit function
+  double (*hmax)(int64_t); //depth limit function
   int (*w_schedule)(const struct clogo_state *);
                            //w schedule function
+  void (*select)(struct clogo_state *);
+                           //selection engine expanding the
+                           //cells of a step; NULL=SOO/LOGO
+                           //depth groups (select_nodes)
   int init_w;              //w value at iteration 0
   double epsilon;          //max error before stopping
                            //INFINITY=run until max
   double fn_optimum;       //fn's max value
+  double surrogate;        //safety factor on the estimated
+                           //Lipschitz constant used to skip
+                           //unpromising samples
+                           //0.0=always sample (disabled)
+  const struct clogo_fidelity *fidelities;
+                           //approximations of fn, coarsest
+                           //first; NULL=always use fn
+  int fidelity_count;      //number of `fidelities`
+  int (*fidelity_policy)(int);
+                           //fidelity level to sample a cell
+                           //at given its depth; levels >=
+                           //fidelity_count mean fn itself
+  int local_depth;         //depth the best cell must reach
+                           //before a local Nelder-Mead
+                           //search is run inside it
+                           //0=disabled
+  int local_max;           //max samples per local search
+                           //0=LOCAL_DEFAULT_MAX
+  bool lazy;               //true to defer sampling children
+                           //until they could be selected
+  struct clogo_trace *trace;
+                           //trace to record samples to or
+                           //replay them from; NULL=disabled
+                           //When replaying, objectives may be
+                           //NULL to use recorded values only
+  struct clogo_table *table;
+                           //table of evaluations shared with
+                           //other optimizations of the same
+                           //objective; NULL=disabled
+  int embed_dim;           //number of inputs of the objective
+                           //when partitioning a random DIM-
+                           //dimensional embedding of them
+                           //0=fn takes DIM inputs (disabled)
+  unsigned embed_seed;     //seed of the random embedding
+  const char *storage_path;//directory to keep deep depth 
+                           //levels in, as memory-mapped 
+                           //files; NULL=keep all in memory
+  int storage_depth;       //shallowest depth level kept in
+                           //`storage_path`
+  int noise_k;             //number of evaluations averaged
+                           //before a cell can be expanded, 
+                           //for noisy objectives (StoSOO)
+                           //0=fn is deterministic (disabled)
+  double noise_delta;      //confidence parameter of the 
+                           //bounds on the averages
+                           //0=NOISE_DEFAULT_DELTA
+  double noise_range;      //range of the noise of a single
+                           //evaluation; 0=1.0
+  void (*fn_batch)(double *, int, double *);
+                           //evaluates fn at a number of 
+                           //points (laid out one after the 
+                           //other) at once; NULL=call fn 
+                           //for each point
+  bool (*feasible)(double *);
+                           //cheap constraint check done 
+                           //before sampling a cell; NULL=
+                           //every point is feasible
+  void (*feasible_batch)(double *, int, bool *);
+                           //checks a number of points (laid
+                           //out one after the other) at once
+                           //NULL=call `feasible` for each
+  double infeasible_value; //value of cells violating the
+                           //constraints; must be lower than
+                           //any feasible value of fn
+  const double *resolution;//grid step of each input (DIM 
+                           //entries, in the unit box) the 
+                           //objective can tell apart, e.g.
+                           //1/levels for integer inputs; 
+                           //0=continuous; NULL=all are
+  int batch;               //number of nodes expanded per 
+                           //depth group and step, whose 
+                           //children are sampled together
+                           //0=one, sampling each child on
+                           //its own (SOO)
+  int workers;             //number of threads a batch of 
+                           //samples is spread over, if 
+                           //fn_batch isn't given (fn must
+                           //be thread-safe); 0 or 1=none
+  const double *region;    //part of the unit box to search
+                           //(DIM edges, then DIM sizes); 
+                           //NULL=the whole box
+  void (*fn_vector)(double *, double *);
+                           //evaluates every metric of a 
+                           //vector-valued objective at once
+                           //(replaces fn); NULL=disabled
+  int metric_count;        //number of metrics of fn_vector
+  const double *weights;   //weight of each metric in the 
+                           //value maximized (metric_count 
+                           //entries)
+  struct clogo_vector_store *store;
+                           //metrics evaluated so far, shared
+                           //with other scalarizations; NULL=
+                           //evaluate every point
+  bool adaptive_split;     //true to split cells along the 
+                           //dimension the objective looks
+                           //most sensitive to, among the 
+                           //widest (see split.h); false=
+                           //always the widest
+  bool latency_order;      //true to learn how long the ob-
+                           //jective takes across the box, 
+                           //and hand the evaluations of a
+                           //batch to the workers longest 
+                           //expected first
+  const char *status_path; //file to publish the progress of
+                           //the optimization to after every
+                           //step, for other processes to map
+                           //(see status.h); NULL=disabled
 };
 
 /***********************************************************
@@ -45,7 +187,18 @@ struct clogo_options {
 struct clogo_result {
   double point[DIM];       //point of max value found
   double value;            //max value found
-  int samples;             //number of samples observed
+  int64_t samples;         //number of samples observed
+  int64_t estimates;       //number of samples skipped in
+                           //favor of a surrogate value
+  double cost;             //total cost of all samples, in
+                           //full-fidelity evaluations
+  int64_t feasible;        //number of points that passed the
+                           //constraint check
+  int64_t infeasible;      //number of points that failed it
+                           //(and weren't sampled)
+  int64_t duplicates;      //number of points that snapped to
+                           //an already evaluated grid point
+                           //(and weren't sampled again)
 };
 
 /***********************************************************
@@ -53,34 +206,108 @@ struct clogo_result {
 *
 * A sampled value in the space.
 *
-* A single intrusive linked list is used since each node
-* only needs to be in at most one list of nodes at a time.
-* It just makes implementation that much easier, and maybe
-* is easier on the cache once things start getting crazy.
+* Each node is in exactly one depth list at a time, and 
+* remembers its slot in that list so it can be moved or
+* removed without searching for it.
 *
-* NOTE: Ideally node creation would be managed by some
-* allocation system that can keep nodes at the same depth
-* close in memory to avoid cache misses when iterating
-* through the depth lists.
+* Nodes are allocated from per-depth pools (see storage.h)
+* so nodes at the same depth stay close in memory.
 ***********************************************************/
 struct node {
   double edges[DIM];       //edge of cell in each dimension
   double sizes[DIM];       //size of cell ...
-  double value;            //sampled value at the center
+  double value;            //sampled value at the center, or
+                           //its upper confidence bound for
+                           //noisy objectives
+  double mean;             //mean of the samples at the center
+  int64_t evals;           //number of samples in `mean`
+  double anchor_value;     //value of the real sample that
+                           //backs `value`
+  double anchor_dist;      //distance from the center to the
+                           //anchoring sample
+  bool estimated;          //true if `value` is a surrogate
+                           //lower bound, not a real sample
+  int fidelity;            //fidelity level `value` was
+                           //sampled at
+  bool refined;            //true if a local search has
+                           //already started at the center
+  bool pending;            //true if `value` is only inherited
+                           //from the parent until the node
+                           //is actually sampled (lazy mode)
+  bool infeasible;         //true if the center violates the
+                           //constraints, and `value` is the
+                           //penalty value
+  double latency;          //time the objective took on the
+                           //center, in seconds; 0.0 if not
+                           //timed (see `latency_order`)
   int depth;               //depth in hierarchy
-  struct node *next;       //intrusive linked list pointer
+  int split;               //dimension the parent was split
+                           //along to create the cell; -1 
+                           //for the top cell
+  double sensitivity[DIM]; //slope of the objective last
+                           //observed along each dimension
+                           //around the cell; negative if
+                           //none was (adaptive_split only)
+  int64_t slot;            //index in its list's heap
+  struct node *next;       //next free node, once the node 
+                           //is given back to its pool
+};
+
+/***********************************************************
+* storage_segment
+*
+* A block of nodes allocated at once, either from the C 
+* heap or from a memory-mapped file.
+***********************************************************/
+struct storage_segment {
+  struct storage_segment *next;
+                           //previously allocated segment
+  struct node *nodes;      //array of `capacity` nodes
+  int64_t capacity;        //number of elements in `nodes`
+  int64_t used;            //number of `nodes` handed out
+  bool mapped;             //true if `nodes` is file-backed
+};
+
+/***********************************************************
+* node_pool
+*
+* Allocator of the nodes of a single depth level.
+***********************************************************/
+struct node_pool {
+  const char *path;        //directory backing the pool with
+                           //files; NULL=plain memory
+  struct storage_segment *segments;
+                           //segments, newest first
+  struct node *free;       //nodes given back to the pool,
+                           //linked through `next`
+  bool failed;             //true if a file couldn't be 
+                           //mapped, so the pool fell back 
+                           //to plain memory for good
 };
 
 /***********************************************************
 * node_list
 *
-* A list of nodes. Since this is implemented via intrusive
-* linked list, we just need to hold the first node in the
-* list. This structure just exists for flexibility or future
-* expansion.
+* A list of nodes, kept as a binary max-heap so the best
+* node is always first and selection never has to walk 
+* the nodes themselves. The heap array comes from the same
+* kind of memory as the nodes, but a copy of the best node
+* is kept in the list itself, in RAM, so comparing levels
+* doesn't page in file-backed ones.
 ***********************************************************/
 struct node_list {
-  struct node *first;      //first node in the list
+  struct node **heap;      //nodes, best first
+  bool mapped;             //true if `heap` is file-backed
+  struct node top;         //copy of the best node, valid 
+                           //while `count` > 0
+  int64_t count;           //number of nodes in the list
+  int64_t capacity;        //number of elements in `heap`
+  int64_t touched;         //value of the space's `clock`
+                           //when the list last changed
+  bool released;           //true if the list's file-backed
+                           //memory was handed back to the 
+                           //OS since it was last touched
+  struct node_pool pool;   //allocator of the list's nodes
 };
 
 /***********************************************************
@@ -90,11 +317,20 @@ struct node_list {
 * nodes at varying depths that cover the whole space.
 *
 * `depth` points to a dynamic array of `capacity` node
-* lists, each holding all the cells at that level.
+* lists, each holding all the cells at that level. Cells
+* that can't be split are moved to `final` instead, but 
+* still live in the pool of their depth.
 ***********************************************************/
 struct space {
   struct node_list *depth; //array of depth node lists
   int capacity;            //number of elements in `depth`
+  struct node_list final;  //cells no wider than the input
+                           //resolution, which can't be 
+                           //split any further
+  int64_t clock;           //number of steps taken so far
+  bool unmapped;           //true once a file couldn't be 
+                           //mapped for a level, so no more
+                           //levels are file-backed
 };
 
 /***********************************************************
@@ -108,10 +344,64 @@ struct clogo_state {
                            //options that define the optimi-
                            //zation process
   struct space space;      //current partitioned input space
-  int samples;             //number of samples observed
+  int64_t samples;         //number of samples observed
+  int64_t estimates;       //number of surrogate values used
+                           //in place of samples (and not
+                           //sampled since)
+  double window[SURROGATE_WINDOW];
+                           //most recent slopes observed 
+                           //between a sampled parent and 
+                           //child (ring buffer)
+  double lipschitz;        //largest slope in `window`, used
+                           //as a local Lipschitz estimate
+  int slopes;              //number of slopes observed
+  int64_t deferred;        //number of nodes whose sampling
+                           //is currently deferred
+  double cost;             //total cost of all samples, in
+                           //full-fidelity evaluations
+  int64_t feasible;        //number of points that passed the
+                           //constraint check
+  int64_t infeasible;      //number of points that failed it
+  struct clogo_table *dedup;
+                           //grid points evaluated so far;
+                           //NULL if there's no resolution
+  int64_t duplicates;      //number of evaluations skipped
+                           //thanks to `dedup`
+  struct node **batch;     //children deferred until the end
+                           //of the current batch; NULL if
+                           //not batched
+  int batched;             //number of nodes in `batch`
+  int batch_capacity;      //number of elements in `batch`
+  int64_t *fidelity_samples;
+                           //number of samples taken at each
+                           //fidelity level (fidelity_count+1
+                           //entries, the last being fn)
+  double local_best_value; //best value found by local
+                           //searches; -INFINITY if none
+  double local_best_point[DIM];
+                           //point of `local_best_value`
+  int local_runs;          //number of local searches run
+  double noise_best_value; //best mean of a cell evaluated 
+                           //noise_k times; -INFINITY if none
+  double noise_best_point[DIM];
+                           //center of that cell
+  double *embedding;       //random projection (embed_dim
+                           //rows of DIM); NULL if disabled
+  double *embedded;        //scratch point of embed_dim 
+                           //inputs passed to the objective
   double last_best_value;  //best value observed in the pre-
                            //vious iteration
   int w;                   //current w value
+  double hmax_scale;       //factor applied to hmax
+  struct clogo_bandit *bandit;
+                           //statistics of the bandit w 
+                           //schedule; NULL if not used
+  struct clogo_status_page *status;
+                           //page the progress is published
+                           //to; NULL if not published
+  struct clogo_latency *latency;
+                           //learned evaluation times; NULL
+                           //unless `latency_order` is set
   bool valid;              //true if the state can be used
                            //for further optimization steps
 };
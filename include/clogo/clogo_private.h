@@ -20,6 +20,39 @@ void select_nodes(
                            //ess
 );
 
+/***********************************************************
+* group_resolved_node
+*
+* Returns the best node with a depth between `h_min` and
+* `h_max` (inclusive) whose value can be trusted, or NULL
+* if there are none. If the candidate's value was deferred
+* or only comes from a coarse fidelity, it's sampled 
+* properly and the choice is made again, since the ranking
+* may have changed. Refinements are paid for out of the 
+* same budget, so this gives up as soon as it's been used.
+* Cells that can't be split anymore are set aside once 
+* their value can be trusted, so they don't block the rest
+* of their group.
+***********************************************************/
+struct node * group_resolved_node(
+  struct clogo_state *state,  
+                           //current optimization state
+  int h_min,               //shallowest depth in the group
+  int h_max                //deepest depth in the group
+);
+
+/***********************************************************
+* group_best_node
+*
+* Returns the best node with a depth between `h_min` and 
+* `h_max` (inclusive), or NULL if there are none.
+***********************************************************/
+struct node * group_best_node(
+  const struct space *s,   //space to examine
+  int h_min,               //shallowest depth in the group
+  int h_max                //deepest depth in the group
+);
+
 /***********************************************************
 * make_result
 *
@@ -65,6 +98,66 @@ void sample_node(
   struct clogo_state *state//current optimization state
 );
 
+/***********************************************************
+* record_sample
+*
+* Fills out the given node structure with a value sampled 
+* at its center.
+***********************************************************/
+void record_sample(
+  struct node *n,          //node to modify
+  int level,               //fidelity level sampled at
+  double value,            //sampled value
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* sample_child_node
+*
+* Samples a non-middle child node, unless the surrogate 
+* model shows it can't be promising. `n->fidelity` must 
+* hold the fidelity of the anchoring sample on entry.
+* If `direct` is true, the anchor is a real sample of the 
+* parent and the new sample also updates the surrogate.
+***********************************************************/
+void sample_child_node(
+  struct node *n,          //node to sample
+  double anchor_value,     //value of the anchoring sample
+  double dist,             //distance from the center of `n`
+                           //to the anchoring sample
+  bool direct,             //true if the anchor was sampled
+                           //at the parent's center
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* resolve_node
+*
+* Makes sure the value of a node can be trusted for 
+* selection: samples nodes whose sampling was deferred or 
+* skipped in favor of a surrogate value, refines values
+* sampled at a coarse fidelity, and averages noisy values
+* over enough evaluations. Returns true if the node's 
+* value changed, meaning any selection based on it has to
+* be redone.
+***********************************************************/
+bool resolve_node(
+  struct node *n,          //node to resolve
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* resolve_best_node
+*
+* Resolves the best node of the space until the best node's
+* value can be trusted, and returns it. This keeps deferred
+* or coarse values from deciding termination or being 
+* reported as a result.
+***********************************************************/
+struct node * resolve_best_node(
+  struct clogo_state *state//current optimization state
+);
+
 /***********************************************************
 * expand_and_remove_node
 *
@@ -79,6 +172,31 @@ double expand_and_remove_node(
   struct clogo_state *state//system state
 );
 
+/***********************************************************
+* expand_removed_node
+*
+* Expands the referenced node, which has already been 
+* removed from the input space, adding its children to the
+* next depth level. Also deletes the node being expanded.
+* Returns the value of the best child node created.
+***********************************************************/
+double expand_removed_node(
+  struct node *n,          //node to expand
+  struct clogo_state *state//system state
+);
+
+/***********************************************************
+* split_count
+*
+* Returns the number of children a cell at the given depth
+* is split into.
+***********************************************************/
+int split_count(
+  const struct clogo_options *opt,
+                           //problem definition
+  int depth                //depth of the cell to split
+);
+
 /***********************************************************
 * create_child_node
 *
@@ -92,8 +210,10 @@ struct node * create_child_node(
                            //current state to modify
   int split_dim,           //index of the dimension to split
                            //on
-  int idx                  //index of the current node being
+  int idx,                 //index of the current node being
                            //created
+  bool feasible            //false if the node's center 
+                           //violates the constraints
 );
 
 /***********************************************************
@@ -117,6 +237,34 @@ struct node * list_best_node(
                            //node list to examine
 );
 
+/***********************************************************
+* list_best_copy
+*
+* Returns the in-memory copy of the best node of a list, 
+* which compares the same as the node itself but never 
+* pages in file-backed memory, or NULL if the list is 
+* empty.
+***********************************************************/
+const struct node * list_best_copy(
+  const struct node_list *l
+                           //node list to examine
+);
+
+/***********************************************************
+* node_better
+*
+* Returns true if node `a` should be preferred over node `b`
+* (which may be NULL). On ties, nodes that have actually 
+* been sampled win over nodes whose sampling was deferred,
+* then deeper nodes, then the cell with the lowest edges.
+* This is a total order over the live cells, so selection
+* doesn't depend on the order nodes were created in.
+***********************************************************/
+bool node_better(
+  const struct node *a,    //candidate node
+  const struct node *b     //best node so far, or NULL
+);
+
 /***********************************************************
 * space_best_node
 *
@@ -161,13 +309,24 @@ void init_node_list(
 /***********************************************************
 * add_node_to_list
 *
-* Adds the given node to the beginning of the given list.
+* Adds the given node to the given list.
 ***********************************************************/
 void add_node_to_list(
   struct node *n,          //node to add
   struct node_list *l      //list to modify
 );
 
+/***********************************************************
+* update_node_in_list
+*
+* Restores the order of the given list after the value of
+* one of its nodes changed.
+***********************************************************/
+void update_node_in_list(
+  struct node *n,          //node whose value changed
+  struct node_list *l      //list containing the node
+);
+
 /***********************************************************
 * add_node_to_space
 *
@@ -201,6 +360,28 @@ void remove_node_from_space(
   struct space *s          //space to modify
 );
 
+/***********************************************************
+* retire_node
+*
+* Moves a cell that can't be split any further from its 
+* depth list to the list of final cells of the space.
+***********************************************************/
+void retire_node(
+  struct node *n,          //node to move
+  struct space *s          //space containing the node
+);
+
+/***********************************************************
+* space_exhausted
+*
+* Returns true if every cell of the space has been split
+* down to the resolution of the inputs, so there's nothing
+* left to expand.
+***********************************************************/
+bool space_exhausted(
+  const struct space *s    //space to examine
+);
+
 /***********************************************************
 * grow_space
 *
@@ -221,6 +402,19 @@ void calculate_center(
   double *center           //output center point array
 );
 
+/***********************************************************
+* budget_spent
+*
+* Returns true if the sample budget of the optimization has
+* been used up. Cells found infeasible don't cost anything,
+* but they're bounded by the same budget so that searching
+* an (almost) entirely infeasible space still ends.
+***********************************************************/
+bool budget_spent(
+  const struct clogo_state *state
+                           //state to examine
+);
+
 /***********************************************************
 * term_cond_met
 *
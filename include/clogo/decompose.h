@@ -0,0 +1,46 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Fraction of a leading region's cost a trailing region may
+//spend before waiting for it, when rebalancing.
+#define DECOMPOSE_TRAIL 0.5
+//Time a waiting region sleeps between checks (us).
+#define DECOMPOSE_POLL 100
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_decompose
+*
+* Splits the box into `count` slabs along the first 
+* dimension and optimizes each one in its own process. The
+* processes share the best value found so far and the cost
+* spent through shared memory, so the budget in `opt` and
+* the termination check are global. If `rebalance` is true,
+* regions trailing the global best hold off while the 
+* regions leading the search catch up, so budget flows to
+* the most promising regions; otherwise each region gets 
+* its even share. Traces and evaluation tables aren't 
+* shared between processes. `results` receives the result
+* of each region; the combined result is returned.
+***********************************************************/
+struct clogo_result clogo_decompose(
+  const struct clogo_options *opt,
+                           //options to run with
+  int count,               //number of regions (processes)
+  bool rebalance,          //true to move budget towards the
+                           //leading regions
+  struct clogo_result *results
+                           //output result of each region
+);
@@ -0,0 +1,44 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Minimum improvement over the best value, relative to it,
+//a cell has to be able to promise to be selected by DIRECT.
+#define DIRECT_EPSILON 1e-4
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_direct_select
+*
+* DIRECT selection engine. Every step expands the cells 
+* that are potentially optimal: the best cell of a depth is
+* if some Lipschitz constant K >= 0 makes its value plus K 
+* times its half-diagonal the largest bound of all, by at 
+* least DIRECT_EPSILON. These are the cells on the upper
+* convex hull of (size, value), from the best cell to the
+* largest one.
+*
+* Cells of a depth all have the same size, so only the best
+* node of each depth can be on the hull; the hull is built
+* from those, sorted by size, without looking at any other
+* node. With adaptive splitting the cells of a depth only
+* have the same volume, and their best node stands for the
+* depth with its own size.
+*
+* Setting this as the options' `select` is all it takes. 
+* The w schedule and hmax are ignored, and batched 
+* expansion isn't supported.
+***********************************************************/
+void clogo_direct_select(
+  struct clogo_state *state//current optimization state
+);
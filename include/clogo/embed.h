@@ -0,0 +1,72 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_embed_map
+*
+* Maps a point of the DIM-dimensional box being partitioned
+* into the `embed_dim`-dimensional input space of the 
+* objective, through the random projection described by the
+* options (REMBO-style). The low dimensional unit box is 
+* scaled to [-sqrt(DIM), sqrt(DIM)], projected, clipped to 
+* [-1, 1] and scaled back to the unit box.
+***********************************************************/
+void clogo_embed_map(
+  const struct clogo_options *opt,
+                           //options holding the embedding
+  const double *point,     //DIM-dimensional point
+  double *out              //output embed_dim point
+);
+
+/***********************************************************
+* clogo_embed_restarts
+*
+* Runs `count` independent optimizations, each with its own
+* random embedding (seeds embed_seed, embed_seed+1, ...),
+* on separate threads. `results` receives each result and 
+* `points` (count*embed_dim entries) each best point mapped
+* into the objective's input space. Returns the index of 
+* the best result.
+***********************************************************/
+int clogo_embed_restarts(
+  const struct clogo_options *opt,
+                           //options to run with
+  int count,               //number of embeddings to try
+  struct clogo_result *results,
+                           //output result of each embedding
+  double *points           //output high dimensional points
+);
+
+/***********************************************************
+* embed_projection
+*
+* Fills `matrix` (embed_dim rows of DIM entries) with the 
+* standard normal random projection for the given seed.
+***********************************************************/
+void embed_projection(
+  int embed_dim,           //number of rows
+  unsigned seed,           //seed of the projection
+  double *matrix           //output projection matrix
+);
+
+/***********************************************************
+* embed_apply
+*
+* Maps a point through an already generated projection 
+* matrix. See clogo_embed_map.
+***********************************************************/
+void embed_apply(
+  const double *matrix,    //projection matrix
+  int embed_dim,           //number of rows of `matrix`
+  const double *point,     //DIM-dimensional point
+  double *out              //output embed_dim point
+);
@@ -0,0 +1,144 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+#include <stddef.h>
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of points whose registers are evaluated together;
+//small enough for every register to stay in cache.
+#define EXPR_CHUNK 256
+//Number of register entries evaluations keep on the stack
+//instead of allocating them.
+#define EXPR_STACK 4096
+//Number of points below which they're evaluated one at a
+//time rather than in a chunk.
+#define EXPR_SCALAR 8
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* expr_op
+*
+* Operation of a single bytecode instruction.
+***********************************************************/
+enum expr_op {
+  EXPR_CONST,              //constant `value`
+  EXPR_VAR,                //input `a`, mapped into bounds
+  EXPR_NEG,                //-a
+  EXPR_ADD,                //a + b
+  EXPR_SUB,                //a - b
+  EXPR_MUL,                //a * b
+  EXPR_DIV,                //a / b
+  EXPR_POW,                //a ^ b
+  EXPR_SQUARE,             //a ^ 2
+  EXPR_SIN,                //sin(a)
+  EXPR_COS,                //cos(a)
+  EXPR_TAN,                //tan(a)
+  EXPR_TANH,               //tanh(a)
+  EXPR_EXP,                //exp(a)
+  EXPR_LOG,                //log(a)
+  EXPR_SQRT,               //sqrt(a)
+  EXPR_ABS                 //fabs(a)
+};
+
+/***********************************************************
+* expr_instr
+*
+* A single bytecode instruction. Every instruction writes 
+* its own register (the one with its index), so operands 
+* always refer to earlier instructions. Compiled code holds
+* no two identical instructions, and none the result 
+* doesn't depend on.
+***********************************************************/
+struct expr_instr {
+  enum expr_op op;         //operation
+  int a;                   //first operand register, or input
+                           //index of EXPR_VAR
+  int b;                   //second operand register
+  double value;            //value of EXPR_CONST
+};
+
+/***********************************************************
+* clogo_expr
+*
+* Objective function compiled from an expression of the 
+* inputs x and y (or x0, x1, ...). Inputs in the unit box 
+* are mapped to [lo, hi] before the expression sees them.
+***********************************************************/
+struct clogo_expr {
+  struct expr_instr *code; //instructions
+  int count;               //number of instructions
+  int capacity;            //number of elements in `code`
+  int result;              //register holding the value
+  double lo[DIM];          //lower bound of each input
+  double hi[DIM];          //upper bound of each input
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_expr_parse
+*
+* Compiles an expression made of numbers, the inputs, the
+* constants pi and e, + - * / ^ (right associative, binding
+* tighter than unary minus), parentheses, and the functions
+* sin, cos, tan, tanh, exp, log, sqrt and abs. Bounds start
+* out as the unit box. Returns false and describes the 
+* problem in `error` if the expression is invalid.
+***********************************************************/
+bool clogo_expr_parse(
+  struct clogo_expr *e,    //output compiled expression
+  const char *text,        //expression to compile
+  char *error,             //output error message
+  size_t error_size        //size of `error`
+);
+
+/***********************************************************
+* clogo_expr_delete
+*
+* Frees a compiled expression.
+***********************************************************/
+void clogo_expr_delete(
+  struct clogo_expr *e     //expression to delete
+);
+
+/***********************************************************
+* clogo_expr_map
+*
+* Maps a point of the unit box into the bounds of the 
+* expression's inputs.
+***********************************************************/
+void clogo_expr_map(
+  const struct clogo_expr *e,
+                           //expression holding the bounds
+  const double *point,     //point of the unit box
+  double *out              //output point within the bounds
+);
+
+/***********************************************************
+* clogo_expr_eval
+*
+* Evaluates the expression at `count` points of the unit 
+* box (laid out one after the other). Each instruction runs
+* over a whole chunk of points at once, unless there are 
+* only a few points.
+***********************************************************/
+void clogo_expr_eval(
+  const struct clogo_expr *e,
+                           //expression to evaluate
+  const double *points,    //points to evaluate at
+  int count,               //number of points
+  double *values           //output value at each point
+);
@@ -0,0 +1,53 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* feasible_point
+*
+* Returns true if the given point satisfies the constraints
+* of the options (always, if there are none), and accounts
+* for the check in the state.
+***********************************************************/
+bool feasible_point(
+  struct clogo_state *state,
+                           //current optimization state
+  double *point            //point to check
+);
+
+/***********************************************************
+* feasible_children
+*
+* Checks the centers of all `k` children a node would be 
+* split into along `split_dim` against the constraints, as
+* a single batch, and stores whether each one is feasible 
+* in `out`. The middle child shares its parent's center, so
+* it isn't checked again.
+***********************************************************/
+void feasible_children(
+  const struct node *parent,
+                           //node about to be split
+  int split_dim,           //dimension to split along
+  struct clogo_state *state,
+                           //current optimization state
+  bool *out                //output feasibility of each child
+);
+
+/***********************************************************
+* feasible_mark
+*
+* Fills a node whose center violates the constraints with
+* the penalty value of the options instead of sampling it.
+***********************************************************/
+void feasible_mark(
+  struct node *n,          //node to mark
+  struct clogo_state *state//current optimization state
+);
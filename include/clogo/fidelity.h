@@ -0,0 +1,113 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* fidelity_full
+*
+* Returns the fidelity level that corresponds with the real
+* objective function.
+***********************************************************/
+int fidelity_full(
+  const struct clogo_options *opt
+                           //problem definition
+);
+
+/***********************************************************
+* fidelity_level
+*
+* Returns the fidelity level a cell at the given depth
+* should be sampled at, according to the policy in the 
+* options structure.
+***********************************************************/
+int fidelity_level(
+  const struct clogo_options *opt,
+                           //problem definition
+  int depth                //depth of the cell to sample
+);
+
+/***********************************************************
+* fidelity_evaluate
+*
+* Evaluates the objective at the given fidelity level and
+* point, and accounts for the sample and its cost in the
+* state.
+***********************************************************/
+double fidelity_evaluate(
+  struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  double *point            //point to evaluate
+);
+
+/***********************************************************
+* fidelity_evaluate_batch
+*
+* Evaluates the objective at the given fidelity level and 
+* `count` points (laid out one after the other), and 
+* accounts for the samples and their cost in the state. 
+* This is the only place objective functions are called, 
+* so it's also where traces are recorded/replayed, shared 
+* evaluation tables are consulted and points are snapped to
+* the resolution of the inputs. The points that actually
+* need the objective are handed to it all at once, and 
+* timed to train the latency model if there is one.
+***********************************************************/
+void fidelity_evaluate_batch(
+  struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  double *points,          //points to evaluate
+  int count,               //number of points
+  double *values,          //output value of each point
+  double *seconds          //output time the objective took
+                           //on each point (0.0 if it wasn't
+                           //called or timed); NULL=not 
+                           //needed
+);
+
+/***********************************************************
+* fidelity_evaluate_repeated
+*
+* Evaluates the objective `count` times at the same point,
+* as fidelity_evaluate would, in a single batch.
+***********************************************************/
+void fidelity_evaluate_repeated(
+  struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  double *point,           //point to evaluate
+  int count,               //number of evaluations
+  double *values           //output value of each evaluation
+);
+
+/***********************************************************
+* fidelity_refine
+*
+* If the given node was sampled at a coarse fidelity, 
+* resample it using the real objective function and return 
+* true. Returns false if the node's value was already 
+* sampled at full fidelity.
+***********************************************************/
+bool fidelity_refine(
+  struct node *n,          //node to refine
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* init_fidelity_accounting
+*
+* Allocates the per-fidelity sample counters of a freshly
+* created state.
+***********************************************************/
+void init_fidelity_accounting(
+  struct clogo_state *state//state to initialize
+);
@@ -0,0 +1,46 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Initial number of buckets of the table of snapped points
+//that have already been evaluated. It grows as needed.
+#define GRID_TABLE_BUCKETS (1 << 10)
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* grid_snap
+*
+* Snaps a point to the center of the grid step it falls in,
+* along every dimension with a resolution. Dimensions 
+* without one are copied as they are.
+***********************************************************/
+void grid_snap(
+  const struct clogo_options *opt,
+                           //options holding the resolution
+  const double *point,     //point to snap
+  double *out              //output snapped point
+);
+
+/***********************************************************
+* grid_split_dim
+*
+* Returns the dimension a cell should be split along: the
+* widest one that is still wider than the resolution. 
+* Returns -1 if the cell is no wider than the resolution 
+* along any dimension and shouldn't be split at all.
+***********************************************************/
+int grid_split_dim(
+  const struct clogo_options *opt,
+                           //options holding the resolution
+  const struct node *n     //cell to split
+);
@@ -0,0 +1,93 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+#include "clogo/table.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of lattice cells per dimension evaluation times 
+//are learned over.
+#define LATENCY_GRID 16
+//Initial number of buckets of the table of observed 
+//lattice cells. It grows as needed.
+#define LATENCY_BUCKETS (1 << 8)
+//Weight of the newest evaluation time in the moving 
+//average of its cell.
+#define LATENCY_DECAY 0.3
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_latency
+*
+* Model of how long the objective takes to evaluate across
+* the unit box: a moving average of the measured times of
+* the evaluations in each cell of a regular lattice, and of
+* all evaluations for cells never evaluated in. Only cells
+* that were evaluated in are stored, keyed by their lattice
+* coordinates, so the model grows with the number of 
+* evaluations rather than with LATENCY_GRID^DIM.
+***********************************************************/
+struct clogo_latency {
+  struct clogo_table cells;//average time of each observed 
+                           //lattice cell, in seconds
+  double mean;             //average time of every evaluation
+  int64_t observed;        //number of evaluations timed
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* latency_init
+*
+* Allocates the latency model of a freshly created state,
+* if the options ask for cost-aware dispatch.
+***********************************************************/
+void latency_init(
+  struct clogo_state *state//state to initialize
+);
+
+/***********************************************************
+* latency_delete
+*
+* Frees the latency model of a state, if it has one.
+***********************************************************/
+void latency_delete(
+  struct clogo_state *state//state to clean up
+);
+
+/***********************************************************
+* latency_observe
+*
+* Adds the measured time of an evaluation at the given 
+* point (in the unit box) to the model.
+***********************************************************/
+void latency_observe(
+  struct clogo_latency *l, //model to update
+  const double *point,     //point evaluated
+  double seconds           //time the evaluation took
+);
+
+/***********************************************************
+* latency_order
+*
+* Fills `order` with the indices of `count` points (laid 
+* out one after the other), longest expected evaluation 
+* first. Points expected to take as long keep their order.
+***********************************************************/
+void latency_order(
+  struct clogo_latency *l, //model to consult
+  const double *points,    //points to be evaluated
+  int count,               //number of points
+  int *order               //output order of evaluation
+);
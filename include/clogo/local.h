@@ -0,0 +1,46 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Sample limit of a single local search if the options 
+//don't specify one.
+#define LOCAL_DEFAULT_MAX 200
+//Simplex size (relative to the size of the cell being 
+//searched) at which a local search is considered converged.
+#define LOCAL_MIN_STEP 1e-4
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* local_enabled
+*
+* Returns true if the given node should be refined by a 
+* local search.
+***********************************************************/
+bool local_enabled(
+  const struct clogo_state *state,
+                           //current optimization state
+  const struct node *n     //candidate node
+);
+
+/***********************************************************
+* local_refine
+*
+* Runs a Nelder-Mead search inside the bounds of the given
+* cell, starting from its center. Samples share the budget
+* of the optimization, and the best point found is recorded
+* in the state as the best-known value.
+***********************************************************/
+void local_refine(
+  struct node *n,          //cell to search in
+  struct clogo_state *state//current optimization state
+);
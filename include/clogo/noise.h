@@ -0,0 +1,46 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Confidence parameter of the bounds if none is given.
+#define NOISE_DEFAULT_DELTA 0.05
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* noise_set
+*
+* Sets the statistics of a node from the mean of `evals` 
+* evaluations at its center. In noisy mode, the node's value
+* becomes the upper confidence bound of the mean (in the 
+* style of StoSOO); otherwise it's the mean itself.
+***********************************************************/
+void noise_set(
+  struct node *n,          //node to modify
+  double mean,             //mean of the evaluations
+  int64_t evals,           //number of evaluations
+  const struct clogo_state *state
+                           //current optimization state
+);
+
+/***********************************************************
+* noise_refine
+*
+* In noisy mode, evaluates a node that has been evaluated
+* fewer than `noise_k` times as many more times as needed,
+* as a single batch, and returns true. Returns false if the
+* node doesn't need any more evaluations.
+***********************************************************/
+bool noise_refine(
+  struct node *n,          //node to refine
+  struct clogo_state *state//current optimization state
+);
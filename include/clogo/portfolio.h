@@ -0,0 +1,57 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Initial number of buckets of the evaluation table shared
+//by the members of a portfolio. It grows as needed.
+#define PORTFOLIO_TABLE_BUCKETS (1 << 12)
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_portfolio_result
+*
+* Summary of a portfolio run. Individual member results are
+* returned separately.
+***********************************************************/
+struct clogo_portfolio_result {
+  int first;               //index of the member that
+                           //finished first
+  long unique;             //number of distinct evaluations
+                           //of the objective
+  int64_t samples;         //total samples of all members
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_portfolio
+*
+* Runs several optimizations of the same objective at the
+* same time, one thread each. The members share a table of
+* evaluations so no point is evaluated twice, and the best 
+* value found by any member feeds every member's 
+* termination check. The members all start together, and
+* one that stops on another's optimum returns that point.
+* The objective must be thread safe. `results` receives 
+* one result per member.
+***********************************************************/
+struct clogo_portfolio_result clogo_portfolio(
+  const struct clogo_options *members,
+                           //options of each member
+  int count,               //number of members
+  struct clogo_result *results
+                           //output result of each member
+);
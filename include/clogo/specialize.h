@@ -0,0 +1,274 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* clogo_spec_error
+*
+* Error of a value given the known optimum-- identical to
+* val_error, but usable without an options structure.
+***********************************************************/
+static inline double clogo_spec_error(
+  double optimum,          //known optimum of the function
+  double val               //value to consider
+)
+{
+#ifdef LOGO_ERROR
+  if (optimum == 0.0) return optimum - val;
+  return (optimum - val) / optimum;
+#else
+  return optimum - val;
+#endif
+} /* clogo_spec_error() */
+
+/*********************************************************************
+* MACROS
+*********************************************************************/
+
+/***********************************************************
+* CLOGO_DEFINE_OPTIMIZER
+*
+* Defines a copy of the plain SOO/LOGO optimization path
+* (init, step, select_nodes, expand_and_remove_node) that is
+* specialized at compile time for one problem, so the 
+* compiler can inline the objective, depth limit and w 
+* schedule, and unroll the loops over dimensions and 
+* splits. None of the optional modes of clogo_options are
+* available.
+*
+*   name     - name of the generated function; the types 
+*              name##_result and name##_node are defined too
+*   dim      - number of dimensions (compile-time constant)
+*   k        - odd number of splits per cell (constant)
+*   fn       - double fn(double *point)
+*   hmax     - double hmax(int64_t samples)
+*   schedule - int schedule(int w, bool improved), returning
+*              the next w given whether the best value 
+*              improved during the last step
+*
+* The generated function is
+*   struct name##_result name(
+*     int64_t max, int init_w, double epsilon, double optimum)
+* with the same meaning as the clogo_options fields.
+***********************************************************/
+#define CLOGO_DEFINE_OPTIMIZER(name, dim, k, fn, hmax, schedule)     \
+                                                                     \
+_Static_assert((k) % 2 == 1, "k must be odd");                       \
+                                                                     \
+struct name##_result {                                               \
+  double point[dim];       /*point of max value found*/              \
+  double value;            /*max value found*/                       \
+  int64_t samples;         /*number of samples observed*/            \
+};                                                                   \
+                                                                     \
+struct name##_node {                                                 \
+  double edges[dim];       /*edge of cell in each dimension*/        \
+  double sizes[dim];       /*size of cell ...*/                      \
+  double value;            /*sampled value at the center*/           \
+  int depth;               /*depth in hierarchy*/                    \
+  struct name##_node *next;/*intrusive linked list pointer*/         \
+};                                                                   \
+                                                                     \
+struct name##_space {                                                \
+  struct name##_node **depth;                                        \
+                           /*array of depth node lists*/             \
+  int capacity;            /*number of elements in `depth`*/         \
+  int64_t samples;         /*number of samples observed*/            \
+};                                                                   \
+                                                                     \
+static inline void name##_sample(                                    \
+  struct name##_space *s,                                            \
+  struct name##_node *n                                              \
+)                                                                    \
+{                                                                    \
+  double center[dim];                                                \
+  for (int i = 0; i < (dim); i++) {                                  \
+    center[i] = n->edges[i] + n->sizes[i]/2.0;                       \
+  }                                                                  \
+  n->value = fn(center);                                             \
+  s->samples++;                                                      \
+}                                                                    \
+                                                                     \
+static inline void name##_add(                                       \
+  struct name##_space *s,                                            \
+  struct name##_node *n                                              \
+)                                                                    \
+{                                                                    \
+  while (s->capacity <= n->depth) {                                  \
+    int cap = s->capacity * 2;                                       \
+    s->depth = realloc(s->depth, sizeof(*s->depth) * cap);           \
+    for (int i = s->capacity; i < cap; i++) s->depth[i] = NULL;      \
+    s->capacity = cap;                                               \
+  }                                                                  \
+  n->next = s->depth[n->depth];                                      \
+  s->depth[n->depth] = n;                                            \
+}                                                                    \
+                                                                     \
+static inline void name##_remove(                                    \
+  struct name##_space *s,                                            \
+  struct name##_node *n                                              \
+)                                                                    \
+{                                                                    \
+  struct name##_node **p = &s->depth[n->depth];                      \
+  while (*p != n) p = &(*p)->next;                                   \
+  *p = n->next;                                                      \
+}                                                                    \
+                                                                     \
+static inline bool name##_better(                                    \
+  const struct name##_node *a,                                       \
+  const struct name##_node *b                                        \
+)                                                                    \
+{                                                                    \
+  /*Same canonical order as node_better*/                            \
+  if (b == NULL) return true;                                        \
+  if (a->value != b->value) return a->value > b->value;              \
+  if (a->depth != b->depth) return a->depth > b->depth;              \
+  for (int i = 0; i < (dim); i++) {                                  \
+    if (a->edges[i] != b->edges[i]) return a->edges[i] < b->edges[i];\
+  }                                                                  \
+  return false;                                                      \
+}                                                                    \
+                                                                     \
+static inline struct name##_node * name##_depth_best(                \
+  const struct name##_space *s,                                      \
+  int h                                                              \
+)                                                                    \
+{                                                                    \
+  if (h >= s->capacity) return NULL;                                 \
+  struct name##_node *best = s->depth[h];                            \
+  for (struct name##_node *n = best; n != NULL; n = n->next) {       \
+    if (name##_better(n, best)) best = n;                            \
+  }                                                                  \
+  return best;                                                       \
+}                                                                    \
+                                                                     \
+static inline struct name##_node * name##_space_best(                \
+  const struct name##_space *s                                       \
+)                                                                    \
+{                                                                    \
+  struct name##_node *best = NULL;                                   \
+  for (int h = 0; h < s->capacity; h++) {                            \
+    struct name##_node *b = name##_depth_best(s, h);                 \
+    if (b != NULL && name##_better(b, best)) best = b;               \
+  }                                                                  \
+  return best;                                                       \
+}                                                                    \
+                                                                     \
+static inline double name##_expand(                                  \
+  struct name##_space *s,                                            \
+  struct name##_node *n,                                             \
+  int64_t max,                                                       \
+  double epsilon,                                                    \
+  double optimum,                                                    \
+  bool *done                                                         \
+)                                                                    \
+{                                                                    \
+  double best = -INFINITY;                                           \
+  name##_remove(s, n);                                               \
+  int split_dim = n->depth % (dim);                                  \
+  double width = n->sizes[split_dim] / (k);                          \
+  for (int idx = 0; idx < (k); idx++) {                              \
+    struct name##_node *c = malloc(sizeof(*c));                      \
+    for (int i = 0; i < (dim); i++) {                                \
+      c->edges[i] = n->edges[i];                                     \
+      c->sizes[i] = n->sizes[i];                                     \
+    }                                                                \
+    c->edges[split_dim] += width * idx;                              \
+    c->sizes[split_dim] = width;                                     \
+    c->depth = n->depth + 1;                                         \
+    if (idx == (k) / 2) {                                            \
+      c->value = n->value;                                           \
+    } else {                                                         \
+      name##_sample(s, c);                                           \
+    }                                                                \
+    name##_add(s, c);                                                \
+    if (c->value > best) best = c->value;                            \
+    if (s->samples >= max ||                                         \
+        clogo_spec_error(optimum, best) < epsilon) {                 \
+      *done = true;                                                  \
+      break;                                                         \
+    }                                                                \
+  }                                                                  \
+  free(n);                                                           \
+  return best;                                                       \
+}                                                                    \
+                                                                     \
+static struct name##_result name(                                    \
+  int64_t max,                                                       \
+  int init_w,                                                        \
+  double epsilon,                                                    \
+  double optimum                                                     \
+)                                                                    \
+{                                                                    \
+  struct name##_space s = {                                          \
+    .depth = calloc(1, sizeof(*s.depth)),                            \
+    .capacity = 1,                                                   \
+    .samples = 0                                                     \
+  };                                                                 \
+  struct name##_node *top = malloc(sizeof(*top));                    \
+  for (int i = 0; i < (dim); i++) {                                  \
+    top->edges[i] = 0.0;                                             \
+    top->sizes[i] = 1.0;                                             \
+  }                                                                  \
+  top->depth = 0;                                                    \
+  name##_sample(&s, top);                                            \
+  name##_add(&s, top);                                               \
+                                                                     \
+  int w = init_w;                                                    \
+  double last_best = -INFINITY;                                      \
+  bool done = (                                                      \
+    s.samples >= max ||                                              \
+    clogo_spec_error(optimum, top->value) < epsilon                  \
+  );                                                                 \
+  while (!done) {                                                    \
+    double prev_best = -INFINITY;                                    \
+    int kmax = (int)(hmax(s.samples) / w);                           \
+    for (int g = 0; g <= kmax && !done; g++) {                       \
+      struct name##_node *best = NULL;                               \
+      for (int h = g*w; h <= (g+1)*w-1; h++) {                       \
+        struct name##_node *b = name##_depth_best(&s, h);            \
+        if (b != NULL && name##_better(b, best)) best = b;           \
+      }                                                              \
+      if (best != NULL && best->value > prev_best) {                 \
+        prev_best = best->value;                                     \
+        name##_expand(&s, best, max, epsilon, optimum, &done);       \
+      }                                                              \
+    }                                                                \
+    double new_best = name##_space_best(&s)->value;                  \
+    w = schedule(w, new_best > last_best);                           \
+    last_best = new_best;                                            \
+    done = done || (                                                 \
+      s.samples >= max ||                                            \
+      clogo_spec_error(optimum, new_best) < epsilon                  \
+    );                                                               \
+  }                                                                  \
+                                                                     \
+  struct name##_result result;                                       \
+  struct name##_node *best = name##_space_best(&s);                  \
+  for (int i = 0; i < (dim); i++) {                                  \
+    result.point[i] = best->edges[i] + best->sizes[i]/2.0;           \
+  }                                                                  \
+  result.value = best->value;                                        \
+  result.samples = s.samples;                                        \
+                                                                     \
+  for (int h = 0; h < s.capacity; h++) {                             \
+    struct name##_node *n = s.depth[h];                              \
+    while (n != NULL) {                                              \
+      struct name##_node *next = n->next;                            \
+      free(n);                                                       \
+      n = next;                                                      \
+    }                                                                \
+  }                                                                  \
+  free(s.depth);                                                     \
+  return result;                                                     \
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Largest ratio between the widest dimension of a cell and
+//a dimension adaptive splitting may still choose, so every
+//dimension keeps shrinking as cells get deeper.
+#define SPLIT_ASPECT 27.0
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* split_dim
+*
+* Returns the dimension a cell should be split along, or -1
+* if it's no wider than the resolution along any dimension
+* and shouldn't be split at all. By default this is the
+* widest dimension (see grid_split_dim). With adaptive 
+* splitting, it's the one where splitting is expected to
+* change the values the most (the cell's sensitivity along
+* it times its width) among those at least 1/SPLIT_ASPECT
+* as wide as the widest; dimensions with no sensitivity 
+* observed around the cell yet come first.
+***********************************************************/
+int split_dim(
+  const struct clogo_state *state,
+                           //current optimization state
+  const struct node *n     //cell to split
+);
+
+/***********************************************************
+* split_observe
+*
+* Sets the sensitivity of a freshly sampled child along the
+* dimension its parent was split along to the slope from
+* the sample at its parent's center. Takes the same 
+* arguments as surrogate_observe.
+***********************************************************/
+void split_observe(
+  double anchor_value,     //value of the parent's sample
+  double dist,             //distance from the center of `n`
+                           //to the parent's center
+  int anchor_fidelity,     //fidelity of the parent's sample
+  struct node *n,          //freshly sampled child
+  struct clogo_state *state//current optimization state
+);
+
+
+/***********************************************************
+* split_share
+*
+* Gives every child of an expansion the steepest slope its
+* sampled siblings observed along the split dimension, so
+* the middle child, which keeps its parent's sample, and 
+* the children that were only estimated learn it too. 
+* Children still pending (lazy or batched) are skipped and 
+* only ever learn their own slope.
+***********************************************************/
+void split_share(
+  struct node **children,  //children of the expansion, in
+                           //order along the split dimension
+  int count,               //number of `children`
+  const struct clogo_state *state
+                           //current optimization state
+);
@@ -0,0 +1,137 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+#include <stdatomic.h>
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Value of the first word of a status page ("CLGO").
+#define STATUS_MAGIC 0x434C474FU
+//Number of depth levels counted separately in a status 
+//page; deeper levels are added to the last count.
+#define STATUS_DEPTHS 64
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_status
+*
+* Snapshot of the progress of an optimization, as published
+* after every step.
+***********************************************************/
+struct clogo_status {
+  int64_t steps;           //number of steps taken so far
+  int64_t samples;         //number of samples observed
+  double cost;             //total cost of all samples
+  int w;                   //current w value
+  double best_value;       //best value found so far
+  double best_point[DIM];  //point of `best_value`
+  int depth_count;         //number of `depths` in use
+  int64_t depths[STATUS_DEPTHS];
+                           //number of cells at each depth
+  int64_t final;           //number of cells that can't be 
+                           //split any further
+  bool done;               //true once the optimization has
+                           //met its termination conditions
+                           //or was deleted
+};
+
+/***********************************************************
+* clogo_status_page
+*
+* Status of an optimization shared with other processes 
+* through a memory-mapped file. The optimizer is the only
+* writer and bumps `sequence` before and after every 
+* update (seqlock), so readers never block it: they simply
+* copy the snapshot again if `sequence` was odd or changed
+* while they were copying it.
+***********************************************************/
+struct clogo_status_page {
+  uint32_t magic;          //STATUS_MAGIC once published
+  uint32_t dim;            //DIM of the writer
+  _Atomic uint64_t sequence;
+                           //odd while `status` is written
+  struct clogo_status status;
+                           //latest snapshot
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* status_open
+*
+* Creates (or truncates) the file at the `status_path` of
+* the options and maps it as the state's status page.
+* Nothing is done if there's no `status_path`; if the page
+* can't be created, the error is reported on stderr and 
+* the state is left without one.
+***********************************************************/
+void status_open(
+  struct clogo_state *state//optimization state to publish
+);
+
+/***********************************************************
+* status_publish
+*
+* Publishes a snapshot of the state to its status page, if
+* it has one. Takes no system call.
+***********************************************************/
+void status_publish(
+  struct clogo_state *state//optimization state to publish
+);
+
+/***********************************************************
+* status_close
+*
+* Publishes a last snapshot marked as done and unmaps the
+* status page. The file stays, so the final status can 
+* still be read.
+***********************************************************/
+void status_close(
+  struct clogo_state *state//optimization state to publish
+);
+
+/***********************************************************
+* clogo_status_map
+*
+* Maps the status page published at the given path for
+* reading. Returns NULL if the file can't be mapped or 
+* doesn't hold a status page of the same DIM.
+***********************************************************/
+const struct clogo_status_page * clogo_status_map(
+  const char *path         //file given as `status_path`
+);
+
+/***********************************************************
+* clogo_status_unmap
+*
+* Unmaps a page mapped by clogo_status_map.
+***********************************************************/
+void clogo_status_unmap(
+  const struct clogo_status_page *page
+                           //page to unmap
+);
+
+/***********************************************************
+* clogo_status_read
+*
+* Copies a consistent snapshot out of a status page, 
+* retrying while the writer is in the middle of an update.
+* Takes no system call and never blocks the writer.
+***********************************************************/
+void clogo_status_read(
+  const struct clogo_status_page *page,
+                           //page to read
+  struct clogo_status *out //output snapshot
+);
@@ -0,0 +1,82 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+#include <stddef.h>
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of steps a depth level can go without changing 
+//before its file-backed memory is handed back to the OS.
+#define STORAGE_COLD_STEPS 16
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* storage_alloc
+*
+* Allocates an uninitialized node for the given depth level
+* from that level's pool, growing the space as needed. 
+* Levels at or below `storage_depth` are backed by memory-
+* mapped files in `storage_path`, if one is set, so they 
+* are bounded by disk rather than by RAM. If a file can't
+* be created or mapped, the error is reported on stderr 
+* and the level falls back to plain memory.
+***********************************************************/
+struct node * storage_alloc(
+  struct clogo_state *state,
+                           //state owning the space
+  int depth                //depth level of the new node
+);
+
+/***********************************************************
+* storage_grow
+*
+* Grows the heap array of a list to `capacity` elements, in
+* the same kind of memory as the nodes of its pool.
+***********************************************************/
+void storage_grow(
+  struct node_list *l,     //list whose heap to grow
+  int64_t capacity         //new number of heap elements
+);
+
+/***********************************************************
+* storage_free
+*
+* Gives a node that has been removed from the space back to
+* the pool of its depth level.
+***********************************************************/
+void storage_free(
+  struct clogo_state *state,
+                           //state owning the space
+  struct node *n           //node to free
+);
+
+/***********************************************************
+* storage_release_cold
+*
+* Hands the file-backed memory of depth levels that haven't
+* changed for STORAGE_COLD_STEPS steps back to the OS.
+* The nodes stay valid and are read back from their files
+* when touched again.
+***********************************************************/
+void storage_release_cold(
+  struct clogo_state *state//state owning the space
+);
+
+/***********************************************************
+* storage_delete_list
+*
+* Frees a list's heap array and every segment of its pool,
+* along with all the nodes allocated from it.
+***********************************************************/
+void storage_delete_list(
+  struct node_list *l      //list to delete
+);
@@ -0,0 +1,66 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of parent/child slopes that must be observed before
+//the Lipschitz estimate is trusted enough to skip samples.
+#define SURROGATE_MIN_SLOPES 8
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* surrogate_estimate
+*
+* Decides whether a node can skip its sample (in the style
+* of BaMSOO). The node's value is bounded by a local 
+* Lipschitz model anchored at the nearest real sample of 
+* its ancestry. If the upper bound can't beat the best 
+* value observed so far, the node is filled with the lower
+* bound, flagged as estimated, and true is returned. 
+* Otherwise nothing is modified and false is returned, 
+* meaning the node must really be sampled.
+***********************************************************/
+bool surrogate_estimate(
+  struct node *n,          //node to consider
+  double anchor_value,     //value of the anchoring sample
+  double dist,             //distance from the center of `n`
+                           //to the anchoring sample
+  struct clogo_state *state//current optimization state
+);
+
+/***********************************************************
+* surrogate_observe
+*
+* Updates the Lipschitz estimate of the state using a 
+* freshly sampled node and the sample it was anchored at.
+* Nodes that are only estimated, or that were sampled at a
+* different fidelity than the anchor, are ignored.
+***********************************************************/
+void surrogate_observe(
+  double anchor_value,     //value of the anchoring sample
+  double dist,             //distance from the center of `n`
+                           //to the anchoring sample
+  int anchor_fidelity,     //fidelity of the anchoring sample
+  const struct node *n,    //freshly sampled node
+  struct clogo_state *state//state to update
+);
+
+/***********************************************************
+* center_distance
+*
+* Returns the euclidean distance between the centers of two
+* nodes.
+***********************************************************/
+double center_distance(
+  const struct node *a,    //first node
+  const struct node *b     //second node
+);
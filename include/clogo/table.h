@@ -0,0 +1,198 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of locks the buckets of a table are striped over.
+//Also the smallest number of buckets of a table.
+#define TABLE_STRIPES 64
+//Average number of entries per bucket above which a table
+//doubles its buckets.
+#define TABLE_LOAD 2
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* table_status
+*
+* What table_claim found out about a point.
+***********************************************************/
+enum table_status {
+  TABLE_FOUND,             //evaluated, its value was copied
+  TABLE_CLAIMED,           //claimed by the caller, who must
+                           //evaluate it and call table_fill
+  TABLE_BUSY               //being evaluated by another thread
+                           //(see table_wait)
+};
+
+/***********************************************************
+* table_entry
+*
+* A single evaluated (or being evaluated) point. Entries 
+* are chained per bucket.
+***********************************************************/
+struct table_entry {
+  double point[DIM];       //evaluated point
+  int level;               //fidelity level it was sampled at
+  double value;            //value of the objective
+  bool ready;              //false while still being evaluated
+  struct table_entry *next;//next entry in the same bucket
+};
+
+/***********************************************************
+* clogo_table
+*
+* In-memory table of evaluated points. A shared table lets
+* several optimizations, in as many threads, avoid 
+* evaluating any point twice: its buckets are protected by
+* striped locks, and a thread can wait for a point another
+* is still evaluating. A private table belongs to a single
+* optimization and is never locked. Either kind doubles its
+* buckets as it fills up.
+***********************************************************/
+struct clogo_table {
+  struct table_entry **buckets;
+                           //array of bucket chains
+  int64_t bucket_count;    //number of `buckets`, a power of
+                           //two and a multiple of the number
+                           //of stripes, so an entry keeps 
+                           //its stripe when the table grows
+  bool shared;             //true if threads share the table
+  _Atomic int64_t entries; //number of entries stored
+  pthread_mutex_t locks[TABLE_STRIPES];
+                           //locks protecting the buckets
+                           //(shared tables only)
+  pthread_cond_t filled[TABLE_STRIPES];
+                           //signalled when an entry of the
+                           //stripe becomes ready
+  pthread_mutex_t best_lock;
+                           //lock protecting the fields below
+  double best;             //best full fidelity value stored
+  double best_point[DIM];  //point of `best`
+  long unique;             //number of distinct evaluations
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_table_init
+*
+* Initialize an empty table with room for about 
+* `bucket_count` entries before it first grows. Only a 
+* `shared` table may be used by several threads at once.
+***********************************************************/
+void clogo_table_init(
+  struct clogo_table *t,   //table to initialize
+  int64_t bucket_count,    //initial number of buckets
+  bool shared              //true if threads share the table
+);
+
+/***********************************************************
+* clogo_table_delete
+*
+* Frees every entry of a table. No thread may be using it.
+***********************************************************/
+void clogo_table_delete(
+  struct clogo_table *t    //table to delete
+);
+
+/***********************************************************
+* table_hash
+*
+* Hashes `size` bytes (FNV-1a). Shared by every hash table
+* of the library, so they all spread their keys the same 
+* way.
+***********************************************************/
+uint64_t table_hash(
+  const void *data,        //bytes to hash
+  size_t size              //number of bytes
+);
+
+/***********************************************************
+* table_claim
+*
+* Looks up a point without ever blocking. If it has already
+* been evaluated, its value is stored in `value`. If nobody
+* has seen it yet, it's claimed by the caller. If another
+* thread is evaluating it right now, TABLE_BUSY is returned
+* and the caller may table_wait for it -- but only once it 
+* has filled all of its own claims, or two threads waiting
+* on each other's claims would wait forever.
+***********************************************************/
+enum table_status table_claim(
+  struct clogo_table *t,   //table to search
+  int level,               //fidelity level to sample at
+  const double *point,     //point to look up
+  double *value            //output value, if found
+);
+
+/***********************************************************
+* table_lookup
+*
+* Looks up a point without claiming it. Returns true, and 
+* stores its value in `value`, only if it has been filled.
+***********************************************************/
+bool table_lookup(
+  struct clogo_table *t,   //table to search
+  int level,               //fidelity level
+  const double *point,     //point to look up
+  double *value            //output value, if found
+);
+
+/***********************************************************
+* table_wait
+*
+* Waits for another thread to fill a point table_claim
+* reported as TABLE_BUSY, and returns its value. The caller
+* must not hold any unfilled claim.
+***********************************************************/
+double table_wait(
+  struct clogo_table *t,   //table to search
+  int level,               //fidelity level sampled at
+  const double *point      //point being evaluated
+);
+
+/***********************************************************
+* table_fill
+*
+* Stores the value of a point previously claimed with 
+* table_claim and wakes up anyone waiting for it. A point
+* of a private table may be filled again to replace its
+* value.
+***********************************************************/
+void table_fill(
+  struct clogo_table *t,   //table to modify
+  int level,               //fidelity level sampled at
+  const double *point,     //point that was evaluated
+  double value,            //value of the objective
+  bool full                //true if `level` is the real
+                           //objective
+);
+
+/***********************************************************
+* table_best
+*
+* Returns the best full fidelity value in the table, and 
+* stores its point in `point` unless that is NULL.
+***********************************************************/
+double table_best(
+  struct clogo_table *t,   //table to examine
+  double *point            //output point of the best value,
+                           //or NULL
+);
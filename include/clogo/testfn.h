@@ -0,0 +1,69 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* rosenbrock_2
+*
+* 2D rosenbrock function - maps [0,1] to [-5,10].
+***********************************************************/
+double rosenbrock_2(
+  double *i
+);
+
+/***********************************************************
+* sin_helper
+*
+* Convenience function for calculating sin_X.
+***********************************************************/
+double sin_helper(
+  double x
+);
+
+/***********************************************************
+* sin_2
+*
+* 2D sin test function.
+***********************************************************/
+double sin_2(
+  double *i
+);
+
+/***********************************************************
+* rosenbrock_stretched_2
+*
+* rosenbrock_2 with the second input only spanning [0.5,
+* 1.5], so it matters much less than the first.
+***********************************************************/
+double rosenbrock_stretched_2(
+  double *i
+);
+
+/***********************************************************
+* rosenbrock_rotated_2
+*
+* rosenbrock_stretched_2 with its inputs rotated by 30 
+* degrees around the center of the box, so neither input
+* is aligned with the stretch.
+***********************************************************/
+double rosenbrock_rotated_2(
+  double *i
+);
+
+/***********************************************************
+* sin_stretched_2
+*
+* sin_2 with the second input only spanning [0.85, 0.9], 
+* around the peak, so it matters much less than the first.
+***********************************************************/
+double sin_stretched_2(
+  double *i
+);
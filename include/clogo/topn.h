@@ -0,0 +1,60 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_optimum
+*
+* A sampled cell center reported by clogo_top_n.
+***********************************************************/
+struct clogo_optimum {
+  double point[DIM];       //center of the cell
+  double value;            //mean of the samples there
+  int depth;               //depth of the cell
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_top_n
+*
+* Fills `out` with up to `n` of the sampled leaves of the 
+* space with the best means, best first, such that no two
+* are closer than `min_separation` (Euclidean, in the unit
+* box). Leaves whose value is only inherited, estimated or
+* a constraint penalty are skipped. Returns the number of 
+* leaves found.
+*
+* Leaves are visited in order of value by walking the 
+* per-depth heaps, each at a logarithmic cost. A value is 
+* an upper bound of the mean (the same without noise), so
+* visited leaves are held back until no unvisited one could
+* have a better mean. Accepted points are hashed on a 
+* lattice of `min_separation` wide cells, so checking the 
+* separation costs a constant per leaf.
+*
+* The walk only stops once `n` leaves are accepted, though,
+* and every leaf too close to an accepted one is visited on
+* the way. A run keeps most of its leaves around its best
+* optima, so a separated query usually visits most of the
+* space (about 80% of the leaves of a sin_2 run), as does a
+* noisy one; the worst case is sorting every leaf. Only a
+* noise-free query without separation visits about `n`.
+***********************************************************/
+int clogo_top_n(
+  const struct clogo_state *state,
+                           //state to examine
+  int n,                   //max number of leaves to return
+  double min_separation,   //min distance between any two
+  struct clogo_optimum *out//output array of `n` leaves
+);
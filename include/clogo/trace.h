@@ -0,0 +1,95 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+#include <stdio.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_trace_mode
+*
+* Whether a trace is being written or read back.
+***********************************************************/
+enum clogo_trace_mode {
+  TRACE_RECORD,            //log every sample to the file
+  TRACE_REPLAY             //feed samples back from the file
+};
+
+/***********************************************************
+* clogo_trace
+*
+* A log of every point passed to the objective along with
+* its value. Recording a run and replaying it later allows
+* profiling the optimizer without the objective, and proves
+* that the selection behaviour didn't change.
+*
+* Each sample is one line of the form
+*   <level> <point[0]> ... <point[DIM-1]> <value>
+* with all numbers written as hex floats so that replays 
+* are bit-for-bit exact.
+***********************************************************/
+struct clogo_trace {
+  enum clogo_trace_mode mode;
+                           //record or replay
+  FILE *file;              //file to write or read
+  long count;              //number of samples seen so far
+  long first_divergence;   //index of the first replayed 
+                           //sample that didn't match the
+                           //recorded one, after which the
+                           //replay stopped; -1 if none
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_trace_init
+*
+* Initialize a trace to use an already opened file. The 
+* file isn't closed by the trace.
+***********************************************************/
+void clogo_trace_init(
+  struct clogo_trace *t,   //trace to initialize
+  FILE *file,              //file to write or read
+  enum clogo_trace_mode mode
+                           //record or replay
+);
+
+/***********************************************************
+* trace_replay
+*
+* Looks up the next sample of a replayed trace. If it 
+* matches the given fidelity level and point, its value is
+* stored in `value` and true is returned. Otherwise the 
+* divergence is reported and false is returned, meaning 
+* the objective has to be called. Once a replay diverged,
+* the runs no longer line up, so it stops: every later call
+* returns false without reading the trace.
+***********************************************************/
+bool trace_replay(
+  struct clogo_trace *t,   //trace to read
+  int level,               //fidelity level being sampled
+  const double *point,     //point being sampled
+  double *value            //output recorded value
+);
+
+/***********************************************************
+* trace_record
+*
+* Appends a sample to a recorded trace.
+***********************************************************/
+void trace_record(
+  struct clogo_trace *t,   //trace to write
+  int level,               //fidelity level sampled
+  const double *point,     //point sampled
+  double value             //value returned by the objective
+);
@@ -0,0 +1,118 @@
+#pragma once
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/clogo.h"
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//Number of buckets of the store created by 
+//clogo_vector_optimize.
+#define VECTOR_STORE_BUCKETS (1 << 16)
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* vector_entry
+*
+* The metrics of a single evaluated point. Entries are 
+* chained per bucket.
+***********************************************************/
+struct vector_entry {
+  struct vector_entry *next;
+                           //next entry in the same bucket
+  double data[];           //input point (`dim` entries), 
+                           //then its metrics
+};
+
+/***********************************************************
+* clogo_vector_store
+*
+* In-memory store of the metrics of a vector-valued 
+* objective, keyed by input point. Optimizations of 
+* different scalarizations that share a store only simulate
+* each point once. Not thread-safe.
+***********************************************************/
+struct clogo_vector_store {
+  struct vector_entry **buckets;
+                           //array of bucket chains
+  int bucket_count;        //number of `buckets`
+  int dim;                 //number of entries of a point
+  int metric_count;        //number of metrics per point
+  int64_t evaluations;     //number of points simulated
+  int64_t hits;            //number of lookups answered from
+                           //the store
+};
+
+
+/*********************************************************************
+* FUNCTION PROTOTYPES
+*********************************************************************/
+
+/***********************************************************
+* clogo_vector_store_init
+*
+* Initialize an empty store for points of `dim` entries and
+* `metric_count` metrics. The store never rehashes, so 
+* `bucket_count` should be in the order of the expected 
+* number of evaluations.
+***********************************************************/
+void clogo_vector_store_init(
+  struct clogo_vector_store *s,
+                           //store to initialize
+  int dim,                 //number of entries of a point
+  int metric_count,        //number of metrics per point
+  int bucket_count         //number of buckets
+);
+
+/***********************************************************
+* clogo_vector_store_delete
+*
+* Frees every entry of a store.
+***********************************************************/
+void clogo_vector_store_delete(
+  struct clogo_vector_store *s
+                           //store to delete
+);
+
+/***********************************************************
+* vector_evaluate
+*
+* Evaluates the weighted sum of the metrics of the vector-
+* valued objective at `count` inputs of `dim` entries, 
+* laid out one after the other. Metrics already in the 
+* options' store aren't simulated again.
+***********************************************************/
+void vector_evaluate(
+  const struct clogo_options *opt,
+                           //options holding the objective
+  double *inputs,          //inputs of the objective
+  int dim,                 //number of entries per input
+  int count,               //number of inputs
+  double *values           //output value of each input
+);
+
+/***********************************************************
+* clogo_vector_optimize
+*
+* Runs one optimization per scalarization of the vector-
+* valued objective in `opt`, taking turns one step at a 
+* time. `weights` holds `count` rows of metric_count 
+* weights. The optimizations share a store, so every point
+* is simulated once and scored by each of them. `results` 
+* receives one result per scalarization; the number of 
+* points simulated is returned.
+***********************************************************/
+int64_t clogo_vector_optimize(
+  const struct clogo_options *opt,
+                           //options to run with
+  const double *weights,   //weights of each scalarization
+  int count,               //number of scalarizations
+  struct clogo_result *results
+                           //output result of each one
+);
@@ -0,0 +1,130 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/bandit.h"
+#include "clogo/clogo_private.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//w value and hmax scale of each arm
+static const int bandit_w[BANDIT_ARMS] = {1, 1, 1, 3, 3, 3, 8, 8, 8};
+static const double bandit_scale[BANDIT_ARMS] = {
+  0.5, 1.0, 2.0, 0.5, 1.0, 2.0, 0.5, 1.0, 2.0
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* bandit_use
+*
+* Makes the given arm the one the next step runs with.
+***********************************************************/
+static void bandit_use(
+  struct clogo_state *state,
+                           //current optimization state
+  int arm                  //arm to use
+)
+{
+  state->bandit->arm = arm;
+  state->w = bandit_w[arm];
+  state->hmax_scale = bandit_scale[arm];
+} /* bandit_use() */
+
+/***********************************************************
+* clogo_bandit_schedule
+*
+* Adaptive w schedule. Each step runs with one of a few 
+* (w, hmax scale) pairs, chosen by UCB1 according to how
+* much each improved the best value per sample so far. 
+* Setting this as the options' w_schedule is all it takes;
+* the arms are picked as the steps are rewarded, and this
+* returns the w of the current one.
+***********************************************************/
+int clogo_bandit_schedule(
+  const struct clogo_state *state
+                           //current optimization state
+)
+{
+  return bandit_w[state->bandit->arm];
+} /* clogo_bandit_schedule() */
+
+/***********************************************************
+* bandit_init
+*
+* Sets up the bandit statistics of a new state, if its 
+* options use the bandit schedule, and the first arm.
+***********************************************************/
+void bandit_init(
+  struct clogo_state *state//state to initialize
+)
+{
+  if (state->opt->w_schedule != &clogo_bandit_schedule) return;
+
+  state->bandit = calloc(1, sizeof(*state->bandit));
+  bandit_use(state, 0);
+} /* bandit_init() */
+
+/***********************************************************
+* bandit_begin
+*
+* Remembers where the step about to run starts from.
+***********************************************************/
+void bandit_begin(
+  struct clogo_state *state//current optimization state
+)
+{
+  state->bandit->best_before = state_best_value(state);
+  state->bandit->samples_before = state->samples;
+} /* bandit_begin() */
+
+/***********************************************************
+* bandit_reward
+*
+* Credits the arm of the step that just ran with its 
+* reward, and picks the arm of the next step by UCB1.
+***********************************************************/
+void bandit_reward(
+  struct clogo_state *state//current optimization state
+)
+{
+  struct clogo_bandit *b = state->bandit;
+  int64_t spent = state->samples - b->samples_before;
+  double gain = state_best_value(state) - b->best_before;
+
+  //Rewards have to lie in [0, 1], whatever the scale of the
+  //objective.
+  double rate = spent > 0 && isfinite(gain) ? gain / spent : 0.0;
+  if (rate > b->max_rate) b->max_rate = rate;
+  double reward = b->max_rate > 0.0 ? rate / b->max_rate : 0.0;
+  b->pulls[b->arm]++;
+  b->rewards[b->arm] += reward;
+  b->total++;
+
+  //Try every arm once, then trade off the average reward 
+  //against how little an arm has been tried.
+  int next = 0;
+  double best = -INFINITY;
+  for (int a = 0; a < BANDIT_ARMS; a++) {
+    if (b->pulls[a] == 0) {
+      next = a;
+      break;
+    }
+    double bound = (
+      b->rewards[a] / b->pulls[a] + 
+      sqrt(2.0 * log((double)b->total) / b->pulls[a])
+    );
+    if (bound > best) {
+      best = bound;
+      next = a;
+    }
+  }
+  bandit_use(state, next);
+} /* bandit_reward() */
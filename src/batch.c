@@ -0,0 +1,327 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/batch.h"
+#include "clogo/clogo_private.h"
+#include "clogo/fidelity.h"
+#include "clogo/split.h"
+#include "clogo/surrogate.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//number of candidates batch_expand looks at per batch slot
+//before it stops skipping neighbours of chosen nodes
+#define BATCH_LOOKAHEAD 4
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* batch_job
+*
+* A batch_map call shared by its threads. Each thread 
+* takes the next input of `order` until there are none 
+* left, so long evaluations handed out first don't hold up
+* the short ones behind them.
+***********************************************************/
+struct batch_job {
+  double (*fn)(double *);  //function to call
+  double *inputs;          //inputs of the function
+  int dim;                 //number of entries per input
+  int count;               //number of inputs
+  const int *order;        //order to call fn in; NULL=the
+                           //inputs' order
+  atomic_int next;         //position in `order` of the next
+                           //input to take
+  double *values;          //output value of each input
+  double *seconds;         //output time fn took on each 
+                           //input; NULL=not timed
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* batch_clock
+*
+* Returns the current wall clock time in seconds.
+***********************************************************/
+static double batch_clock()
+{
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+} /* batch_clock() */
+
+/***********************************************************
+* batch_run
+*
+* Thread entry point of a single worker.
+***********************************************************/
+static void * batch_run(
+  void *arg                //batch_job to work on
+)
+{
+  struct batch_job *job = arg;
+  for (;;) {
+    int p = atomic_fetch_add(&job->next, 1);
+    if (p >= job->count) break;
+    int i = job->order != NULL ? job->order[p] : p;
+
+    double start = job->seconds != NULL ? batch_clock() : 0.0;
+    job->values[i] = (*job->fn)(&job->inputs[i * job->dim]);
+    if (job->seconds != NULL) job->seconds[i] = batch_clock() - start;
+  }
+  return NULL;
+} /* batch_run() */
+
+/***********************************************************
+* batch_map
+*
+* Calls `fn` on `count` inputs of `dim` entries laid out 
+* one after the other, spread over `workers` threads (the
+* calling one included), which take the inputs in the 
+* given order as they become free.
+***********************************************************/
+void batch_map(
+  double (*fn)(double *),  //function to call
+  double *inputs,          //inputs of the function
+  int dim,                 //number of entries per input
+  int count,               //number of inputs
+  int workers,             //number of threads to use
+  const int *order,        //order to call fn in
+  double *values,          //output value of each input
+  double *seconds          //output time of each call
+)
+{
+  if (workers > count) workers = count;
+  if (workers < 1) workers = 1;
+
+  struct batch_job job = {
+    .fn = fn,
+    .inputs = inputs,
+    .dim = dim,
+    .count = count,
+    .order = order,
+    .values = values,
+    .seconds = seconds
+  };
+  atomic_init(&job.next, 0);
+
+  pthread_t *threads = malloc(sizeof(*threads) * workers);
+  for (int i = 1; i < workers; i++) {
+    int err = pthread_create(&threads[i], NULL, batch_run, &job);
+    assert(err == 0);
+    (void)err;
+  }
+
+  //The calling thread works on the batch too.
+  batch_run(&job);
+  for (int i = 1; i < workers; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+} /* batch_map() */
+
+/***********************************************************
+* batch_queue
+*
+* Adds a child whose sampling was deferred to the batch of
+* the current step.
+***********************************************************/
+void batch_queue(
+  struct node *n,          //deferred child node
+  struct clogo_state *state//current optimization state
+)
+{
+  if (state->batched == state->batch_capacity) {
+    state->batch_capacity *= 2;
+    state->batch = realloc(state->batch, sizeof(*state->batch) * state->batch_capacity);
+  }
+  state->batch[state->batched++] = n;
+} /* batch_queue() */
+
+/***********************************************************
+* batch_sample
+*
+* Samples every child in the batch of the current step, 
+* one batch of objective calls per fidelity level, as far
+* as the budget goes. Children the surrogate shows can't be
+* promising are skipped as usual, and children left over 
+* once the budget is spent simply stay deferred. Returns 
+* the value of the best child node sampled.
+***********************************************************/
+static double batch_sample(
+  struct clogo_state *state//current optimization state
+)
+{
+  const struct clogo_options *opt = state->opt;
+  int full = fidelity_full(opt);
+  double best = -INFINITY;
+
+  struct node **nodes = malloc(sizeof(*nodes) * state->batched);
+  bool *direct = malloc(sizeof(*direct) * state->batched);
+  int *anchor_fidelity = malloc(sizeof(*anchor_fidelity) * state->batched);
+  double *points = malloc(sizeof(*points) * DIM * state->batched);
+  double *values = malloc(sizeof(*values) * state->batched);
+  double *seconds = malloc(sizeof(*seconds) * state->batched);
+
+  for (int level = 0; level <= full; level++) {
+    double cost = level < full ? opt->fidelities[level].cost : 1.0;
+    double left = opt->max - state->cost;
+
+    //Gather the children to sample at this level.
+    int count = 0;
+    for (int i = 0; i < state->batched; i++) {
+      struct node *n = state->batch[i];
+      if (!n->pending || fidelity_level(opt, n->depth) != level) continue;
+      if (left <= 0.0) break;
+
+      struct node_list *l = &state->space.depth[n->depth];
+      n->pending = false;
+      state->deferred--;
+      direct[count] = !n->estimated;
+      anchor_fidelity[count] = n->fidelity;
+      if (surrogate_estimate(n, n->anchor_value, n->anchor_dist, state)) {
+        update_node_in_list(n, l);
+        continue;
+      }
+
+      calculate_center(n, &points[count * DIM]);
+      nodes[count++] = n;
+      left -= cost;
+    }
+    if (count == 0) continue;
+
+    fidelity_evaluate_batch(state, level, points, count, values, seconds);
+    for (int i = 0; i < count; i++) {
+      struct node *n = nodes[i];
+      double anchor_value = n->anchor_value;
+      double anchor_dist = n->anchor_dist;
+      record_sample(n, level, values[i], state);
+      n->latency = seconds[i];
+      if (direct[i]) {
+        surrogate_observe(anchor_value, anchor_dist, anchor_fidelity[i], n, state);
+        split_observe(anchor_value, anchor_dist, anchor_fidelity[i], n, state);
+      }
+      update_node_in_list(n, &state->space.depth[n->depth]);
+      if (level >= full && n->evals >= opt->noise_k && n->mean > best) {
+        best = n->mean;
+      }
+    }
+  }
+
+  state->batched = 0;
+  free(seconds);
+  free(values);
+  free(points);
+  free(anchor_fidelity);
+  free(direct);
+  free(nodes);
+  return best;
+} /* batch_sample() */
+
+/***********************************************************
+* batch_adjacent
+*
+* Returns true if the cells of `a` and `b` overlap or share
+* a face, edge or corner.
+***********************************************************/
+static bool batch_adjacent(
+  const struct node *a,    //first node
+  const struct node *b     //second node
+)
+{
+  for (int i = 0; i < DIM; i++) {
+    double eps = 1e-6 * fmin(a->sizes[i], b->sizes[i]);
+    if (a->edges[i] > b->edges[i] + b->sizes[i] + eps) return false;
+    if (b->edges[i] > a->edges[i] + a->sizes[i] + eps) return false;
+  }
+  return true;
+} /* batch_adjacent() */
+
+/***********************************************************
+* batch_expand
+*
+* Expands up to `batch` nodes of the depth group between 
+* `h_min` and `h_max`, best first, starting with `first`. 
+* Only nodes better than `bar` (the best node of every 
+* shallower group) are expanded, so that none of them is 
+* dominated by a node that is both larger and better, and
+* a node whose cell touches one already chosen is skipped,
+* so the batch spreads over separate peaks. The children 
+* of all of them are then sampled together.
+* Returns the value of the best child node sampled.
+***********************************************************/
+double batch_expand(
+  struct node *first,      //best node of the group
+  int h_min,               //shallowest depth in the group
+  int h_max,               //deepest depth in the group
+  double bar,              //value to beat
+  struct clogo_state *state//current optimization state
+)
+{
+  struct space *space = &state->space;
+  int m = state->opt->batch;
+
+  //Take the candidates out of the space first, so that 
+  //children of the first ones can't be chosen in their 
+  //place. A candidate next to an already chosen cell is 
+  //most likely on the same peak, so it is set aside for a
+  //later step in favour of one elsewhere.
+  int limit = BATCH_LOOKAHEAD * m;
+  struct node **chosen = malloc(sizeof(*chosen) * m);
+  struct node **skipped = malloc(sizeof(*skipped) * limit);
+  int count = 0;
+  int skip_count = 0;
+  struct node *n = first;
+  while (n != NULL && n->value > bar) {
+    remove_node_from_space(n, space);
+    bool near = false;
+    for (int i = 0; i < count && !near; i++) {
+      near = batch_adjacent(n, chosen[i]);
+    }
+    if (near) skipped[skip_count++] = n;
+    else chosen[count++] = n;
+    if (count == m || count + skip_count == limit) break;
+    n = group_resolved_node(state, h_min, h_max);
+  }
+  for (int i = 0; i < skip_count; i++) {
+    add_node_to_space(skipped[i], space);
+  }
+  free(skipped);
+
+  double best = -INFINITY;
+  for (int i = 0; i < count; i++) {
+    //If the termination conditions were met, put back the
+    //candidates that won't be expanded so the result is 
+    //still found in the space.
+    if (!state->valid) {
+      add_node_to_space(chosen[i], space);
+      continue;
+    }
+    double child_best = expand_removed_node(chosen[i], state);
+    if (child_best > best) best = child_best;
+  }
+  free(chosen);
+
+  if (state->valid) {
+    double sampled_best = batch_sample(state);
+    if (sampled_best > best) best = sampled_best;
+  }
+  state->batched = 0;
+  return best;
+} /* batch_expand() */
@@ -2,9 +2,24 @@
 * INCLUDES
 *********************************************************************/
 #include "clogo/clogo_private.h"
+#include "clogo/bandit.h"
+#include "clogo/batch.h"
 #include "clogo/debug.h"
+#include "clogo/embed.h"
+#include "clogo/feasible.h"
+#include "clogo/fidelity.h"
+#include "clogo/grid.h"
+#include "clogo/latency.h"
+#include "clogo/local.h"
+#include "clogo/noise.h"
+#include "clogo/split.h"
+#include "clogo/status.h"
+#include "clogo/storage.h"
+#include "clogo/surrogate.h"
+#include "clogo/table.h"
 
 #include <assert.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -55,16 +70,66 @@ struct clogo_state clogo_init(
   struct clogo_state state = {
     .opt = opt,
     .samples = 0,
+    .estimates = 0,
+    .lipschitz = 0.0,
+    .slopes = 0,
+    .deferred = 0,
+    .cost = 0.0,
+    .feasible = 0,
+    .infeasible = 0,
+    .dedup = NULL,
+    .duplicates = 0,
+    .batch = NULL,
+    .batched = 0,
+    .batch_capacity = 0,
+    .fidelity_samples = NULL,
+    .local_best_value = -INFINITY,
+    .local_runs = 0,
+    .noise_best_value = -INFINITY,
+    .embedding = NULL,
+    .embedded = NULL,
     .last_best_value = -INFINITY,
     .w = opt->init_w,
+    .hmax_scale = 1.0,
+    .bandit = NULL,
+    .status = NULL,
+    .latency = NULL,
     .valid = true
   };
 
+  init_fidelity_accounting(&state);
+  bandit_init(&state);
+  latency_init(&state);
+
+  //Generate the random embedding once, rather than for 
+  //every sample.
+  if (opt->embed_dim > 0) {
+    state.embedding = malloc(sizeof(double) * opt->embed_dim * DIM);
+    state.embedded = malloc(sizeof(double) * opt->embed_dim);
+    embed_projection(opt->embed_dim, opt->embed_seed, state.embedding);
+  }
+
+  //Remember which grid points were evaluated already, if 
+  //the inputs are discrete.
+  if (opt->resolution != NULL) {
+    state.dedup = malloc(sizeof(*state.dedup));
+    clogo_table_init(state.dedup, GRID_TABLE_BUCKETS, false);
+  }
+
+  //Each expansion of a batch defers k-1 samples, which is
+  //usually 2. The queue grows if cells are split wider.
+  if (opt->batch > 0) {
+    state.batch_capacity = opt->batch * 2;
+    state.batch = malloc(sizeof(*state.batch) * state.batch_capacity);
+  }
+
   //Create empty input space and populate it with a topmost 
   //node
   init_space(&state.space);
   struct node *top = create_top_node(&state);
   add_node_to_space(top, &state.space);
+  resolve_best_node(&state);
+  status_open(&state);
 
   return state;
 } /* clogo_init() */
@@ -83,17 +148,36 @@ void clogo_step(
   assert(state->valid);
 
   //Select and expand nodes
-  select_nodes(state);
+  if (state->bandit != NULL) bandit_begin(state);
+  if (state->opt->select != NULL) {
+    (*state->opt->select)(state);
+  } else {
+    select_nodes(state);
+  }
 
   //Recalculate w according to the provided schedule
   //function.
+  if (state->bandit != NULL) bandit_reward(state);
   state->w = (*state->opt->w_schedule)(state);
 
   //Updated the best value seen so far-- this is 
   //currently only needed to inform the next iteration
-  //of the w schedule.
-  struct node *best = space_best_node(&state->space);
-  state->last_best_value = best->value;
+  //of the w schedule. Deferred or coarse values can't be 
+  //trusted for that, so make sure it's a real one.
+  struct node *best = resolve_best_node(state);
+
+  //Once the best cell is deep enough, hand it over to a 
+  //local search which converges much faster than further
+  //splitting.
+  if (local_enabled(state, best) && !term_cond_met(state, NULL)) {
+    local_refine(best, state);
+  }
+  state->last_best_value = state_best_value(state);
+
+  //Depth levels this step didn't need can leave memory.
+  state->space.clock++;
+  storage_release_cold(state);
+  status_publish(state);
   
 #ifdef DEBUG
   //Display the current best node for debug purposes
@@ -137,20 +221,27 @@ void clogo_delete(
 )
 {
   struct space *space = &state->space;
+  status_close(state);
 
-  //Destructively delete each depth list
+  //Every node lives in the pool of its depth list, so just
+  //delete the lists.
   for (int h = 0; h < space->capacity; h++) {
-    struct node_list *list = &space->depth[h];  
-    struct node *node = list->first;
-    while (node != NULL) {
-      struct node *next = node->next;
-      free(node);
-      node = next;
-    }
+    storage_delete_list(&space->depth[h]);
   }
+  storage_delete_list(&space->final);
 
   //Delete the depth list itself
   free(space->depth);
+  free(state->fidelity_samples);
+  free(state->embedding);
+  free(state->embedded);
+  free(state->batch);
+  free(state->bandit);
+  latency_delete(state);
+  if (state->dedup != NULL) {
+    clogo_table_delete(state->dedup);
+    free(state->dedup);
+  }
 } /* clogo_delete */
 
 /***********************************************************
@@ -165,11 +256,15 @@ double state_best_value(
 )
 {
   struct node *n = space_best_node(&state->space);
-  if (n != NULL) {
-    return n->value;
-  } else {
-    return -INFINITY;
-  }
+  double best = n != NULL ? n->mean : -INFINITY;
+
+  //The best node of a noisy objective is only the most 
+  //optimistic one-- report the best well-averaged mean.
+  if (state->opt->noise_k > 0) best = state->noise_best_value;
+
+  //Points found by local searches don't live in the space.
+  if (state->local_best_value > best) best = state->local_best_value;
+  return best;
 } /* space_best_value() */
 
 /***********************************************************
@@ -185,8 +280,6 @@ void select_nodes(
 {
   //Convenience alias for the optimization options.
   const struct clogo_options *opt = state->opt;
-  //Convenience alias for the input space.
-  struct space *space = &state->space;
   //The best value of a node up until the current point.
   double prev_best = -INFINITY;
   //Maximum value of `k` for this iteration. Note that this
@@ -194,35 +287,30 @@ void select_nodes(
   //calculates the maximum depth to reach) and the current
   //'depth width' (`w`) of the search. This way the max 
   //depth is never violated.
-  int kmax = (int)((*opt->hmax)(state->samples)/state->w);
+  //Children that skipped or deferred their sample, or that
+  //violate the constraints or were already evaluated, count
+  //as if they had been sampled-- otherwise the depth limit 
+  //would freeze while the tree keeps growing past it.
+  int64_t n = (
+    state->samples + state->estimates + state->deferred + 
+    state->infeasible + state->duplicates
+  );
+  int kmax = (int)((*opt->hmax)(n)*state->hmax_scale/state->w);
 
 #ifdef DEBUG
   //Debug output to display that variables are being 
   //calculated correctly.
-  printf("Selecting (n=%d, w=%d, kmax=%d):\n", state->samples, state->w, kmax);
+  printf("Selecting (n=%" PRId64 ", w=%d, kmax=%d):\n", state->samples, state->w, kmax);
 #endif
 
   //Loop through each set of `w` depths.
   for (int k = 0; k <= kmax; k++) {
-    //Best node observed so far in this set of depths.
-    struct node *best = NULL;
     //Minimum/maximum depth included in this set.
     int h_min = k*state->w;
     int h_max = (k+1)*state->w-1;
-    //For each depth level in the set of depths being 
-    //considered...
-    for (int h = h_min; h <= h_max; h++) {
-      //Find the best node at this depth.
-      struct node *h_best = depth_best_node(space, h);
-
-      //Update the best node pointer if the best node
-      //at our current level is better than the best
-      //node found in the set so far.
-      if (h_best == NULL) continue;
-      if (best == NULL || h_best->value > best->value) {
-        best = h_best; 
-      }
-    }
+    //Best node in this set of depths.
+    struct node *best = group_resolved_node(state, h_min, h_max);
+    if (budget_spent(state)) return;
 
     //If the best node in this depth set is better than
     //every node in the depth sets ABOVE this one, expand
@@ -230,6 +318,7 @@ void select_nodes(
     if (best != NULL && best->value > prev_best) {
       //Update the best-observed-so-far value so that future
       //expansions are correct.
+      double bar = prev_best;
       prev_best = best->value;
 
 #ifdef DEBUG
@@ -245,8 +334,13 @@ void select_nodes(
 #endif
 
       //Expand the node-- this also increases the sample
-      //count.
-      double child_best = expand_and_remove_node(best, state);
+      //count. In batched mode, the next best nodes of the 
+      //group are expanded along with it.
+      double child_best = (
+        state->batch != NULL ?
+        batch_expand(best, h_min, h_max, bar, state) :
+        expand_and_remove_node(best, state)
+      );
 
       //Check termination conditions-- if either is 
       //violated, stop the selection at this point so that
@@ -260,6 +354,79 @@ void select_nodes(
   }
 } /* select_nodes() */
 
+/***********************************************************
+* group_resolved_node
+*
+* Returns the best node with a depth between `h_min` and
+* `h_max` (inclusive) whose value can be trusted, or NULL
+* if there are none. If the candidate's value was deferred
+* or only comes from a coarse fidelity, it's sampled 
+* properly and the choice is made again, since the ranking
+* may have changed. Refinements are paid for out of the 
+* same budget, so this gives up as soon as it's been used.
+* Cells that can't be split anymore are set aside once 
+* their value can be trusted, so they don't block the rest
+* of their group.
+***********************************************************/
+struct node * group_resolved_node(
+  struct clogo_state *state,  
+                           //current optimization state
+  int h_min,               //shallowest depth in the group
+  int h_max                //deepest depth in the group
+)
+{
+  struct space *space = &state->space;
+  struct node *best = group_best_node(space, h_min, h_max);
+  while (best != NULL && !budget_spent(state)) {
+    if (resolve_node(best, state)) {
+      //Choose again.
+    } else if (split_dim(state, best) < 0) {
+      retire_node(best, space);
+    } else {
+      break;
+    }
+    best = group_best_node(space, h_min, h_max);
+  }
+  return best;
+} /* group_resolved_node() */
+
+/***********************************************************
+* group_best_node
+*
+* Returns the best node with a depth between `h_min` and 
+* `h_max` (inclusive), or NULL if there are none.
+***********************************************************/
+struct node * group_best_node(
+  const struct space *s,   //space to examine
+  int h_min,               //shallowest depth in the group
+  int h_max                //deepest depth in the group
+)
+{
+  //Best node observed so far in this set of depths, and
+  //its depth. Levels are compared through their in-memory
+  //copies, so only the winner's is paged in.
+  const struct node *best = NULL;
+  int best_h = -1;
+
+  //For each depth level in the set of depths being 
+  //considered...
+  for (int h = h_min; h <= h_max && h < s->capacity; h++) {
+    //Find the best node at this depth.
+    const struct node *h_best = list_best_copy(&s->depth[h]);
+
+    //Update the best node pointer if the best node
+    //at our current level is better than the best
+    //node found in the set so far.
+    if (h_best == NULL) continue;
+    if (node_better(h_best, best)) {
+      best = h_best;
+      best_h = h;
+    }
+  }
+
+  return best_h >= 0 ? list_best_node(&s->depth[best_h]) : NULL;
+} /* group_best_node() */
+
 /***********************************************************
 * make_result
 *
@@ -272,9 +439,27 @@ struct clogo_result make_result(
 {
   struct clogo_result result;
   struct node *best = space_best_node(&state->space);
-  calculate_center(best, result.point);
-  result.value = best->value;
+  double value = state->opt->noise_k > 0 ? state->noise_best_value : best->mean;
+  if (state->local_best_value > value) {
+    for (int i = 0; i < DIM; i++) {
+      result.point[i] = state->local_best_point[i];
+    }
+    result.value = state->local_best_value;
+  } else if (state->opt->noise_k > 0) {
+    for (int i = 0; i < DIM; i++) {
+      result.point[i] = state->noise_best_point[i];
+    }
+    result.value = state->noise_best_value;
+  } else {
+    calculate_center(best, result.point);
+    result.value = best->mean;
+  }
   result.samples = state->samples;
+  result.estimates = state->estimates;
+  result.cost = state->cost;
+  result.feasible = state->feasible;
+  result.infeasible = state->infeasible;
+  result.duplicates = state->duplicates;
   return result;
 } /* make_result() */
 
@@ -325,10 +510,8 @@ double state_error(
   //calculate the error-- so just return maximum error.
   if (opt->fn_optimum == INFINITY) return INFINITY;
 
-  //Find the best node in the space currently...
-  struct node *space_best = space_best_node(&state->space);
-  assert(space_best != NULL);
-  double best_val = space_best->value;
+  //Find the best value in the state currently...
+  double best_val = state_best_value(state);
 
   return val_error(opt, best_val);
 } /* state_error() */
@@ -345,12 +528,126 @@ void sample_node(
   struct clogo_state *state//current optimization state
 )
 {
-  double center[DIM];
+  double center[DIM], value;
   calculate_center(n, center);
-  n->value = (*state->opt->fn)(center);
-  state->samples++;
+  int level = fidelity_level(state->opt, n->depth);
+  fidelity_evaluate_batch(state, level, center, 1, &value, &n->latency);
+  record_sample(n, level, value, state);
 } /* sample_node() */
 
+/***********************************************************
+* record_sample
+*
+* Fills out the given node structure with a value sampled 
+* at its center.
+***********************************************************/
+void record_sample(
+  struct node *n,          //node to modify
+  int level,               //fidelity level sampled at
+  double value,            //sampled value
+  struct clogo_state *state//current optimization state
+)
+{
+  noise_set(n, value, 1, state);
+  n->fidelity = level;
+  n->anchor_value = n->mean;
+  n->anchor_dist = 0.0;
+  n->estimated = false;
+} /* record_sample() */
+
+/***********************************************************
+* sample_child_node
+*
+* Samples a non-middle child node, unless the surrogate 
+* model shows it can't be promising. `n->fidelity` must 
+* hold the fidelity of the anchoring sample on entry.
+* If `direct` is true, the anchor is a real sample of the 
+* parent and the new sample also updates the surrogate.
+***********************************************************/
+void sample_child_node(
+  struct node *n,          //node to sample
+  double anchor_value,     //value of the anchoring sample
+  double dist,             //distance from the center of `n`
+                           //to the anchoring sample
+  bool direct,             //true if the anchor was sampled
+                           //at the parent's center
+  struct clogo_state *state//current optimization state
+)
+{
+  int anchor_fidelity = n->fidelity;
+  if (surrogate_estimate(n, anchor_value, dist, state)) return;
+
+  sample_node(n, state);
+  if (direct) {
+    surrogate_observe(anchor_value, dist, anchor_fidelity, n, state);
+    split_observe(anchor_value, dist, anchor_fidelity, n, state);
+  }
+} /* sample_child_node() */
+
+/***********************************************************
+* resolve_node
+*
+* Makes sure the value of a node can be trusted for 
+* selection: samples nodes whose sampling was deferred or 
+* skipped in favor of a surrogate value, refines values
+* sampled at a coarse fidelity, and averages noisy values
+* over enough evaluations. Returns true if the node's 
+* value changed, meaning any selection based on it has to
+* be redone.
+***********************************************************/
+bool resolve_node(
+  struct node *n,          //node to resolve
+  struct clogo_state *state//current optimization state
+)
+{
+  //Any change of value moves the node within its list.
+  struct node_list *l = &state->space.depth[n->depth];
+
+  if (n->pending) {
+    //The node still carries the anchor of its parent, with 
+    //the distance to the parent's center already added.
+    n->pending = false;
+    state->deferred--;
+    sample_child_node(n, n->anchor_value, n->anchor_dist, !n->estimated, state);
+    update_node_in_list(n, l);
+    return true;
+  }
+
+  //Surrogate values are only bounds from an estimated slope,
+  //so they are never expanded, reported or used to stop.
+  if (n->estimated) {
+    state->estimates--;
+    sample_node(n, state);
+    update_node_in_list(n, l);
+    return true;
+  }
+
+  //Noisy values are only trusted once they're averaged over
+  //enough evaluations.
+  if (!fidelity_refine(n, state) && !noise_refine(n, state)) return false;
+  update_node_in_list(n, l);
+  return true;
+} /* resolve_node() */
+
+/***********************************************************
+* resolve_best_node
+*
+* Resolves the best node of the space until the best node's
+* value can be trusted, and returns it. This keeps deferred
+* or coarse values from deciding termination or being 
+* reported as a result.
+***********************************************************/
+struct node * resolve_best_node(
+  struct clogo_state *state//current optimization state
+)
+{
+  struct node *best = space_best_node(&state->space);
+  while (best != NULL && !budget_spent(state) && resolve_node(best, state)) {
+    best = space_best_node(&state->space);
+  }
+  return best;
+} /* resolve_best_node() */
+
 /***********************************************************
 * expand_and_remove_node
 *
@@ -364,33 +661,63 @@ double expand_and_remove_node(
   struct node *n,          //node to expand
   struct clogo_state *state   //system state
 )
+{
+  //First, yank the node being expanded out of the input 
+  //space.
+  remove_node_from_space(n, &state->space);
+  return expand_removed_node(n, state);
+} /* expand_and_remove_node() */
+
+/***********************************************************
+* expand_removed_node
+*
+* Expands the referenced node, which has already been 
+* removed from the input space, adding its children to the
+* next depth level. Also deletes the node being expanded.
+* Returns the value of the best child node created.
+***********************************************************/
+double expand_removed_node(
+  struct node *n,          //node to expand
+  struct clogo_state *state   //system state
+)
 {
   //Convenience aliases
   struct space *space = &state->space;
   const struct clogo_options *opt = state->opt;
   //Best child value seen so far
   double best = -INFINITY;
-
-  //First, yank the node being expanded out of the input 
-  //space.
-  remove_node_from_space(n, space);
-
-  //Choose the dimension to split along. 
-  //This is supposed to be the dimension with largest size 
-  //in the parent cell but since the cells are all uniformly 
-  //sized this approach (cycling through the dimensions as 
-  //depth decreases) accomplishes the same thing and is 
-  //easier.
-  int split_dim = n->depth%DIM;
-
-  //Ensure that there's an odd number of splits so the 
-  //middle node can inherint the parent's value without
-  //needing to do an extra function call.
-  assert(opt->k % 2 == 1);
-  for (int i = 0; i < opt->k; i++) {
-    struct node *child = create_child_node(n, state, split_dim, i);
+  //Only full fidelity values are allowed to end the search.
+  int full = fidelity_full(opt);
+
+  //Choose the dimension to split along: the dimension with
+  //largest size in the parent cell. Cells of the unit box 
+  //are all uniformly sized, so this cycles through the 
+  //dimensions as depth increases. Dimensions already split
+  //down to the input resolution are skipped. Adaptive 
+  //splitting may pick a narrower, more sensitive one.
+  int split = split_dim(state, n);
+  assert(split >= 0);
+
+  //Number of children of this cell.
+  int k = split_count(opt, n->depth);
+
+  //Find out which children violate the constraints all at
+  //once, before any of them is sampled.
+  bool *feasible = malloc(sizeof(*feasible) * k);
+  feasible_children(n, split, state, feasible);
+  struct node **children = malloc(sizeof(*children) * k);
+  int created = 0;
+
+  for (int i = 0; i < k; i++) {
+    struct node *child = create_child_node(n, state, split, i, feasible[i]);
     add_node_to_space(child, space);
-    if (child->value > best) best = child->value;
+    children[created++] = child;
+    if (
+      !child->pending && child->fidelity >= full &&
+      child->evals >= opt->noise_k && child->mean > best
+    ) {
+      best = child->mean;
+    }
 
     //Jump out if the termination conditions have been met--
     //this technically leaves a 'hole' in the input space
@@ -402,11 +729,38 @@ double expand_and_remove_node(
     }
   }
 
+  //Let the siblings share what their samples showed about
+  //the split dimension, unless the search stopped early.
+  if (created == k) split_share(children, k, state);
+
   //Finally, delete the expanded and removed node.
-  free(n);
+  free(children);
+  free(feasible);
+  storage_free(state, n);
 
   return best;
-} /* expand_and_remove_node() */
+} /* expand_removed_node() */
+
+/***********************************************************
+* split_count
+*
+* Returns the number of children a cell at the given depth
+* is split into.
+***********************************************************/
+int split_count(
+  const struct clogo_options *opt,
+                           //problem definition
+  int depth                //depth of the cell to split
+)
+{
+  int k = opt->k_schedule != NULL ? (*opt->k_schedule)(depth) : opt->k;
+
+  //Ensure that there's an odd number of splits so the 
+  //middle node can inherint the parent's value without
+  //needing to do an extra function call.
+  assert(k % 2 == 1);
+  return k;
+} /* split_count() */
 
 /***********************************************************
 * create_child_node
@@ -420,18 +774,20 @@ struct node * create_child_node(
   struct clogo_state *state,  //current state to modify
   int split_dim,           //index of the dimension to split
                            //on
-  int idx                  //index of the current node being
+  int idx,                 //index of the current node being
                            //created
+  bool feasible            //false if the node's center 
+                           //violates the constraints
 )
 {
   //Convenience options structure alias.
   const struct clogo_options *opt = state->opt;
   //`k` value -- Number of children per split.
-  int splits = opt->k;
+  int splits = split_count(opt, parent->depth);
   //Calculate the width of the dimension to shrink along.
   double width = parent->sizes[split_dim] / splits;
   //...and allocate space for the new node.
-  struct node *n = malloc(sizeof(*n));
+  struct node *n = storage_alloc(state, parent->depth + 1);
 
   //Each edge will be identical to the parents' edges, other
   //than that along the split dimension.
@@ -445,19 +801,61 @@ struct node * create_child_node(
   //along the split dimension.
   for (int i = 0; i < DIM; i++) {
     n->sizes[i] = (i == split_dim) ? width : parent->sizes[i];
+    n->sensitivity[i] = parent->sensitivity[i];
   }
 
   //Child nodes are one depth deeper than their parent.
   n->depth = parent->depth + 1;
+  n->split = split_dim;
   n->next = NULL;
+  n->refined = false;
+  n->pending = false;
+  n->infeasible = false;
+  n->latency = 0.0;
 
   //If this is the middle node, its center is identical to
   //the parent's center-- so just steal the parent's value!
-  //Otherwise, sample.
-  if (idx == opt->k / 2) {
+  //Otherwise, sample, unless the surrogate model shows the
+  //node can't be promising or sampling is deferred until 
+  //the node could actually be selected.
+  if (idx == splits / 2) {
     n->value = parent->value;
+    n->mean = parent->mean;
+    n->evals = parent->evals;
+    n->anchor_value = parent->anchor_value;
+    n->anchor_dist = parent->anchor_dist;
+    n->estimated = parent->estimated;
+    n->fidelity = parent->fidelity;
+    n->refined = parent->refined;
+    n->infeasible = parent->infeasible;
+    n->latency = parent->latency;
+  } else if (!feasible) {
+    //There's nothing to sample.
+    feasible_mark(n, state);
   } else {
-    sample_node(n, state);
+    //The distance to the anchoring sample can only grow by 
+    //the distance between the parent and child centers 
+    //(triangle inequality), so the surrogate stays valid.
+    double dist = parent->anchor_dist + center_distance(parent, n);
+    n->fidelity = parent->fidelity;
+    n->estimated = parent->estimated;
+
+    if (opt->lazy || state->batch != NULL) {
+      //Keep the parent's value as a provisional key, and 
+      //remember the anchor so the surrogate can still be 
+      //consulted once the node is resolved. Batched 
+      //children are all resolved at the end of the batch.
+      n->value = parent->value;
+      n->mean = parent->mean;
+      n->evals = 0;
+      n->anchor_value = parent->anchor_value;
+      n->anchor_dist = dist;
+      n->pending = true;
+      state->deferred++;
+      if (!opt->lazy) batch_queue(n, state);
+    } else {
+      sample_child_node(n, parent->anchor_value, dist, !parent->estimated, state);
+    }
   }
 
   return n; //Return the fully-created child node.
@@ -474,20 +872,35 @@ struct node * create_top_node(
   struct clogo_state *state//optimization state
 )
 {
-  struct node *n = malloc(sizeof(*n));
+  struct node *n = storage_alloc(state, 0);
 
   //Topmost node has all edges at 0 (minimum) all sizes of 
-  //1 (maximum).
+  //1 (maximum), unless only a region of the box is to be
+  //searched.
+  const double *region = state->opt->region;
   for (int i = 0; i < DIM; i++) {
-    n->edges[i] = 0.0;
-    n->sizes[i] = 1.0;
+    n->edges[i] = region != NULL ? region[i] : 0.0;
+    n->sizes[i] = region != NULL ? region[DIM + i] : 1.0;
+    n->sensitivity[i] = -1.0;
   }
 
   n->depth = 0;
+  n->split = -1;
   n->next = NULL;
+  n->refined = false;
+  n->pending = false;
+  n->infeasible = false;
+  n->latency = 0.0;
 
-  //Now that we know where the node is, calculate its value.
-  sample_node(n, state); 
+  //Now that we know where the node is, calculate its value,
+  //unless it's outside the constraints.
+  double center[DIM];
+  calculate_center(n, center);
+  if (feasible_point(state, center)) {
+    sample_node(n, state);
+  } else {
+    feasible_mark(n, state);
+  }
 
   return n;
 } /* create_top_node() */
@@ -502,23 +915,100 @@ struct node * list_best_node(
                            //node list to examine
 )
 {
-  //Current node being examined-- start at the beginning of
-  //the list.
-  struct node *n = l->first;
-  //Best node observed so far.
-  struct node *best = n;
-  
-  //As long as we're not at the end of the list, update
-  //the best node observed so far.
-  while (n != NULL) {
-    if (n->value > best->value) {
-      best = n;
-    }
-    n = n->next;
+  //The heap always keeps the best node first.
+  return l->count > 0 ? l->heap[0] : NULL;
+} /* list_best_node() */
+
+/***********************************************************
+* list_best_copy
+*
+* Returns the in-memory copy of the best node of a list, 
+* which compares the same as the node itself but never 
+* pages in file-backed memory, or NULL if the list is 
+* empty.
+***********************************************************/
+const struct node * list_best_copy(
+  const struct node_list *l
+                           //node list to examine
+)
+{
+  return l->count > 0 ? &l->top : NULL;
+} /* list_best_copy() */
+
+/***********************************************************
+* place_node
+*
+* Puts a node in the given slot of a list's heap.
+***********************************************************/
+static void place_node(
+  struct node_list *l,     //list to modify
+  struct node *n,          //node to place
+  int64_t slot             //slot to put it in
+)
+{
+  l->heap[slot] = n;
+  n->slot = slot;
+  if (slot == 0) l->top = *n;
+} /* place_node() */
+
+/***********************************************************
+* sift_node
+*
+* Moves a node up or down its list's heap until it's in 
+* order with its parent and children again.
+***********************************************************/
+static void sift_node(
+  struct node_list *l,     //list to modify
+  struct node *n           //node out of place
+)
+{
+  int64_t i = n->slot;
+
+  //Up, while it belongs above its parent...
+  while (i > 0 && node_better(n, l->heap[(i - 1) / 2])) {
+    place_node(l, l->heap[(i - 1) / 2], i);
+    i = (i - 1) / 2;
   }
 
-  return best; //...and return it!
-} /* list_best_node() */
+  //...then down, while a child belongs above it.
+  for (;;) {
+    int64_t c = 2 * i + 1;
+    if (c >= l->count) break;
+    if (c + 1 < l->count && node_better(l->heap[c + 1], l->heap[c])) c++;
+    if (!node_better(l->heap[c], n)) break;
+    place_node(l, l->heap[c], i);
+    i = c;
+  }
+  place_node(l, n, i);
+} /* sift_node() */
+
+/***********************************************************
+* node_better
+*
+* Returns true if node `a` should be preferred over node `b`
+* (which may be NULL). On ties, nodes that have actually 
+* been sampled win over nodes whose sampling was deferred,
+* then deeper nodes win, then the cell closest to the 
+* origin, comparing edges one dimension after the other.
+* Live cells never overlap, so this is a total order that
+* only depends on the cells themselves: no matter in what 
+* order they were created or added to a list, the same 
+* node is always picked.
+***********************************************************/
+bool node_better(
+  const struct node *a,    //candidate node
+  const struct node *b     //best node so far, or NULL
+)
+{
+  if (b == NULL) return true;
+  if (a->value != b->value) return a->value > b->value;
+  if (a->pending != b->pending) return !a->pending;
+  if (a->depth != b->depth) return a->depth > b->depth;
+  for (int i = 0; i < DIM; i++) {
+    if (a->edges[i] != b->edges[i]) return a->edges[i] < b->edges[i];
+  }
+  return false;
+} /* node_better() */
 
 /***********************************************************
 * space_best_node
@@ -529,18 +1019,28 @@ struct node * space_best_node(
   const struct space *s    //space to examine
 )
 {
-  //Best node observed so far.
-  struct node *best = NULL;
+  //Best node observed so far, compared through in-memory
+  //copies, and the list holding it.
+  const struct node *best = NULL;
+  const struct node_list *best_list = NULL;
 
   //Find the best node at each depth in the space and use it
   //to update the best node we've seen so far.
   for (int h = 0; h < s->capacity; h++) {
-    struct node *b = depth_best_node(s, h);  
+    const struct node *b = list_best_copy(&s->depth[h]);
     if (b == NULL) continue;
-    if (best == NULL || b->value > best->value) best = b;
+    if (node_better(b, best)) {
+      best = b;
+      best_list = &s->depth[h];
+    }
   }
 
-  return best; //...and return it.
+  //Cells that can't be split still hold values.
+  const struct node *b = list_best_copy(&s->final);
+  if (b != NULL && node_better(b, best)) best_list = &s->final;
+
+  //...and return it.
+  return best_list != NULL ? list_best_node(best_list) : NULL;
 } /* space_best_node() */
 
 /***********************************************************
@@ -579,6 +1079,9 @@ void init_space(
   //NOTE: Maybe we should start with a higher initial capac-
   //ity, but it actually doesn't matter.
   s->capacity = 1;
+  s->clock = 0;
+  s->unmapped = false;
+  init_node_list(&s->final);
   s->depth = malloc(sizeof(*s->depth)*s->capacity);
   for (int i = 0; i < s->capacity; i++) {
     init_node_list(&s->depth[i]);
@@ -594,23 +1097,52 @@ void init_node_list(
   struct node_list *l      //list to initialize
 )
 {
-  l->first = NULL;
+  l->heap = NULL;
+  l->mapped = false;
+  l->count = 0;
+  l->capacity = 0;
+  l->touched = 0;
+  l->released = false;
+  l->pool.path = NULL;
+  l->pool.segments = NULL;
+  l->pool.free = NULL;
+  l->pool.failed = false;
 } /* init_node_list() */
 
 /***********************************************************
 * add_node_to_list
 *
-* Adds the given node to the beginning of the given list.
+* Adds the given node to the given list.
 ***********************************************************/
 void add_node_to_list(
   struct node *n,          //node to add
   struct node_list *l      //list to modify
 )
 {
-  n->next = l->first;
-  l->first = n;
+  if (l->count == l->capacity) {
+    int64_t capacity = l->capacity > 0 ? l->capacity * 2 : STORAGE_MIN_SEGMENT;
+    storage_grow(l, capacity);
+  }
+
+  //Start at the bottom of the heap and move up from there.
+  place_node(l, n, l->count++);
+  sift_node(l, n);
 } /* add_node_to_list() */
 
+/***********************************************************
+* update_node_in_list
+*
+* Restores the order of the given list after the value of
+* one of its nodes changed.
+***********************************************************/
+void update_node_in_list(
+  struct node *n,          //node whose value changed
+  struct node_list *l      //list containing the node
+)
+{
+  sift_node(l, n);
+} /* update_node_in_list() */
+
 /***********************************************************
 * add_node_to_space
 *
@@ -629,6 +1161,8 @@ void add_node_to_space(
   struct node_list *list = &s->depth[n->depth];
   //...and add the node to it!
   add_node_to_list(n, list);
+  list->touched = s->clock;
+  list->released = false;
 } /* add_node_to_space() */
 
 /***********************************************************
@@ -642,27 +1176,17 @@ void remove_node_from_list(
   struct node_list *l      //list to modify
 )
 {
-  //Since each node is part of a singly-linked list, we
-  //have to keep track of the previous and current nodes
-  //so we can hook them up correctly once we remove one.
-  struct node *prev = NULL;
-  struct node *current = l->first;
-  while (current != NULL) {
-    if (current == n) {
-     if (prev != NULL) {
-        prev->next = n->next;
-     } else {
-        l->first = n->next;
-     }
-     //We removed the node, so jump out.
-     return;
-    }
-    prev = current;
-    current = current->next;
+  //If the node isn't where it says it is, it isn't in the
+  //list at all! Panic!
+  assert(n->slot < l->count && l->heap[n->slot] == n);
+
+  //Fill the hole with the last node of the heap, and move
+  //that one to where it belongs.
+  struct node *last = l->heap[--l->count];
+  if (last != n) {
+    place_node(l, last, n->slot);
+    sift_node(l, last);
   }
-
-  //We didn't find the node to remove! Panic!
-  assert(false);
 } /* remove_node_from_list() */
 
 /***********************************************************
@@ -684,8 +1208,42 @@ void remove_node_from_space(
   struct node_list *l = &s->depth[n->depth];
   //...and remove the requested node from it.
   remove_node_from_list(n, l);
+  l->touched = s->clock;
+  l->released = false;
 } /* remove_node_from_space() */
 
+/***********************************************************
+* retire_node
+*
+* Moves a cell that can't be split any further from its 
+* depth list to the list of final cells of the space.
+***********************************************************/
+void retire_node(
+  struct node *n,          //node to move
+  struct space *s          //space containing the node
+)
+{
+  remove_node_from_space(n, s);
+  add_node_to_list(n, &s->final);
+} /* retire_node() */
+
+/***********************************************************
+* space_exhausted
+*
+* Returns true if every cell of the space has been split
+* down to the resolution of the inputs, so there's nothing
+* left to expand.
+***********************************************************/
+bool space_exhausted(
+  const struct space *s    //space to examine
+)
+{
+  for (int h = 0; h < s->capacity; h++) {
+    if (s->depth[h].count > 0) return false;
+  }
+  return true;
+} /* space_exhausted() */
+
 /***********************************************************
 * grow_space
 *
@@ -731,6 +1289,22 @@ void calculate_center(
   }
 } /* calculate_center() */
 
+/***********************************************************
+* budget_spent
+*
+* Returns true if the sample budget of the optimization has
+* been used up. Cells found infeasible don't cost anything,
+* but they're bounded by the same budget so that searching
+* an (almost) entirely infeasible space still ends.
+***********************************************************/
+bool budget_spent(
+  const struct clogo_state *state
+                           //state to examine
+)
+{
+  return state->cost >= state->opt->max || state->infeasible >= state->opt->max;
+} /* budget_spent() */
+
 /***********************************************************
 * term_cond_met
 *
@@ -753,8 +1327,16 @@ bool term_cond_met(
   //calculate the real best value based on the state.
   double best_val = best_val_p ? *best_val_p : state_best_value(state);
 
+  //Values found by other optimizations sharing our 
+  //evaluation table count as well.
+  if (opt->table != NULL) {
+    double shared = table_best(opt->table, NULL);
+    if (shared > best_val) best_val = shared;
+  }
+
   return (
-    state->samples >= opt->max ||
+    budget_spent(state) ||
+    space_exhausted(&state->space) ||
     val_error(state->opt, best_val) < opt->epsilon
   );
 }
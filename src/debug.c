@@ -40,11 +40,10 @@ void dbg_print_node_list(
   struct node_list *l
 )
 {
-  struct node *n = l->first;
-  do {
+  for (int64_t i = 0; i < l->count; i++) {
     printf("\t");
-    dbg_print_node(n);
-  } while ((n = n->next) != NULL);
+    dbg_print_node(l->heap[i]);
+  }
 } /* dbg_print_node_list() */
 
 /***********************************************************
@@ -59,7 +58,7 @@ void dbg_print_space(
   printf("=====\n");
   for (int i = 0; i < s->capacity; i++) {
     struct node_list *l = &s->depth[i];
-    if (s->depth[i].first == NULL) continue;
+    if (s->depth[i].count == 0) continue;
     printf("Depth %d:\n", i);
     dbg_print_node_list(l);
   }
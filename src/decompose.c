@@ -0,0 +1,236 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#define _DEFAULT_SOURCE
+#include "clogo/decompose.h"
+#include "clogo/clogo_private.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* decompose_region
+*
+* What a region's process publishes to the others.
+***********************************************************/
+struct decompose_region {
+  double cost;             //cost spent in the region so far
+  double best;             //best value found in the region
+  bool done;               //true once the region's process
+                           //stopped searching
+  struct clogo_result result;
+                           //final result of the region
+};
+
+/***********************************************************
+* decompose_shared
+*
+* Memory shared by the processes of a decomposition.
+***********************************************************/
+struct decompose_shared {
+  pthread_mutex_t lock;    //process-shared lock protecting
+                           //everything below
+  double best;             //best value of any region
+  double cost;             //total cost of every region
+  struct decompose_region regions[];
+                           //state of each region
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* decompose_publish
+*
+* Publishes the progress of a region and returns true if 
+* its process should stop: once the global budget is spent
+* or the global best value is good enough. Without 
+* rebalancing, a region also stops once it spent its even
+* share of the budget. With it, `wait` is set if the 
+* region should hold off instead, because it trails the 
+* global best and already spent more than DECOMPOSE_TRAIL
+* times what a leading region did.
+***********************************************************/
+static bool decompose_publish(
+  struct decompose_shared *shared,
+                           //shared memory
+  int index,               //index of the region
+  int count,               //number of regions
+  bool rebalance,          //true to move budget towards the
+                           //leading regions
+  const struct clogo_state *state,
+                           //state of the region
+  bool *wait               //output true if the region 
+                           //should wait for the leaders
+)
+{
+  const struct clogo_options *opt = state->opt;
+  struct decompose_region *r = &shared->regions[index];
+  double best = state_best_value(state);
+
+  pthread_mutex_lock(&shared->lock);
+  shared->cost += state->cost - r->cost;
+  r->cost = state->cost;
+  r->best = best;
+  if (best > shared->best) shared->best = best;
+
+  bool stop = (
+    shared->cost >= opt->max ||
+    val_error(opt, shared->best) < opt->epsilon ||
+    (!rebalance && r->cost >= opt->max / count)
+  );
+
+  //Leaders that stopped searching can't be waited for.
+  *wait = false;
+  for (int i = 0; rebalance && best < shared->best && i < count; i++) {
+    const struct decompose_region *leader = &shared->regions[i];
+    if (leader->done || leader->best < shared->best) continue;
+    if (r->cost > DECOMPOSE_TRAIL * leader->cost) *wait = true;
+  }
+  r->done = stop;
+  pthread_mutex_unlock(&shared->lock);
+  return stop;
+} /* decompose_publish() */
+
+/***********************************************************
+* decompose_run
+*
+* Optimizes a single region. Runs in the region's process.
+***********************************************************/
+static void decompose_run(
+  const struct clogo_options *opt,
+                           //options to run with
+  struct decompose_shared *shared,
+                           //shared memory
+  int index,               //index of the region
+  int count,               //number of regions
+  bool rebalance           //true to move budget towards the
+                           //leading regions
+)
+{
+  //The region is a slab of the box along the first 
+  //dimension.
+  double region[2 * DIM];
+  for (int i = 0; i < DIM; i++) {
+    region[i] = 0.0;
+    region[DIM + i] = 1.0;
+  }
+  region[0] = (double)index / count;
+  region[DIM] = 1.0 / count;
+
+  struct clogo_options o = *opt;
+  o.region = region;
+
+  struct clogo_state state = clogo_init(&o);
+  bool wait;
+  bool stop = decompose_publish(shared, index, count, rebalance, &state, &wait);
+  while (!stop && !clogo_done(&state)) {
+    if (wait) {
+      usleep(DECOMPOSE_POLL);
+    } else {
+      clogo_step(&state);
+    }
+    stop = decompose_publish(shared, index, count, rebalance, &state, &wait);
+  }
+
+  pthread_mutex_lock(&shared->lock);
+  shared->regions[index].done = true;
+  pthread_mutex_unlock(&shared->lock);
+
+  //Nobody else writes to the region's slot.
+  shared->regions[index].result = clogo_finish(&state);
+  clogo_delete(&state);
+} /* decompose_run() */
+
+/***********************************************************
+* clogo_decompose
+*
+* Splits the box into `count` slabs along the first 
+* dimension and optimizes each one in its own process. The
+* processes share the best value found so far and the cost
+* spent through shared memory, so the budget in `opt` and
+* the termination check are global. If `rebalance` is true,
+* regions trailing the global best hold off while the 
+* regions leading the search catch up, so budget flows to
+* the most promising regions; otherwise each region gets 
+* its even share. Traces and evaluation tables aren't 
+* shared between processes. `results` receives the result
+* of each region; the combined result is returned.
+***********************************************************/
+struct clogo_result clogo_decompose(
+  const struct clogo_options *opt,
+                           //options to run with
+  int count,               //number of regions (processes)
+  bool rebalance,          //true to move budget towards the
+                           //leading regions
+  struct clogo_result *results
+                           //output result of each region
+)
+{
+  size_t bytes = sizeof(struct decompose_shared) + sizeof(struct decompose_region) * count;
+  struct decompose_shared *shared = mmap(
+    NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0
+  );
+  assert(shared != MAP_FAILED);
+
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutex_init(&shared->lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+  shared->best = -INFINITY;
+  shared->cost = 0.0;
+  for (int i = 0; i < count; i++) {
+    shared->regions[i].cost = 0.0;
+    shared->regions[i].best = -INFINITY;
+    shared->regions[i].done = false;
+  }
+
+  pid_t *pids = malloc(sizeof(*pids) * count);
+  for (int i = 0; i < count; i++) {
+    pids[i] = fork();
+    assert(pids[i] >= 0);
+    if (pids[i] == 0) {
+      decompose_run(opt, shared, i, count, rebalance);
+      _exit(0);
+    }
+  }
+
+  //Combine the results as they come in.
+  struct clogo_result result = { .value = -INFINITY };
+  for (int i = 0; i < count; i++) {
+    int status;
+    waitpid(pids[i], &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    struct clogo_result *r = &shared->regions[i].result;
+    results[i] = *r;
+    if (r->value > result.value) {
+      for (int d = 0; d < DIM; d++) result.point[d] = r->point[d];
+      result.value = r->value;
+    }
+    result.samples += r->samples;
+    result.estimates += r->estimates;
+    result.cost += r->cost;
+    result.feasible += r->feasible;
+    result.infeasible += r->infeasible;
+    result.duplicates += r->duplicates;
+  }
+
+  free(pids);
+  pthread_mutex_destroy(&shared->lock);
+  munmap(shared, bytes);
+  return result;
+} /* clogo_decompose() */
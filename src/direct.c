@@ -0,0 +1,165 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/direct.h"
+#include "clogo/clogo_private.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* direct_point
+*
+* The best cell of a depth, as a point of the (size, value)
+* plane.
+***********************************************************/
+struct direct_point {
+  double size;             //half-diagonal of the cell
+  double value;            //value of the cell
+  struct node *n;          //the cell itself
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* direct_size
+*
+* Returns the half-diagonal of a cell, which bounds the 
+* distance from its center to any of its points.
+***********************************************************/
+static double direct_size(
+  const struct node *n
+)
+{
+  double sum = 0.0;
+  for (int i = 0; i < DIM; i++) sum += n->sizes[i] * n->sizes[i];
+  return sqrt(sum) / 2.0;
+} /* direct_size() */
+
+/***********************************************************
+* direct_turn
+*
+* Returns the cross product of (b - a) and (c - a), which 
+* is positive if a, b, c turn counterclockwise.
+***********************************************************/
+static double direct_turn(
+  const struct direct_point *a,
+  const struct direct_point *b,
+  const struct direct_point *c
+)
+{
+  return (
+    (b->size - a->size) * (c->value - a->value) -
+    (b->value - a->value) * (c->size - a->size)
+  );
+} /* direct_turn() */
+
+/***********************************************************
+* direct_compare
+*
+* qsort comparator ordering points by increasing size, the
+* best first among points of the same size, and deepest 
+* first among equally good ones.
+***********************************************************/
+static int direct_compare(
+  const void *a,
+  const void *b
+)
+{
+  const struct direct_point *x = a, *y = b;
+  if (x->size != y->size) return x->size < y->size ? -1 : 1;
+  if (x->value != y->value) return x->value > y->value ? -1 : 1;
+  return (y->n->depth > x->n->depth) - (y->n->depth < x->n->depth);
+} /* direct_compare() */
+
+/***********************************************************
+* clogo_direct_select
+*
+* DIRECT selection engine: expands the potentially optimal
+* cells of the space.
+***********************************************************/
+void clogo_direct_select(
+  struct clogo_state *state
+)
+{
+  assert(state->batch == NULL);
+  struct space *space = &state->space;
+
+  //Gather the best cell of every depth, resolving it first.
+  struct direct_point *hull = malloc(sizeof(*hull) * space->capacity);
+  int count = 0;
+  for (int h = space->capacity - 1; h >= 0; h--) {
+    struct node *n = group_resolved_node(state, h, h);
+    if (budget_spent(state)) {
+      free(hull);
+      return;
+    }
+    if (n == NULL) continue;
+    hull[count++] = (struct direct_point){direct_size(n), n->value, n};
+  }
+
+  //Build their upper hull by increasing size, so each point
+  //only has to be checked against the end of the hull 
+  //(monotone chain). Deeper cells are usually smaller, but 
+  //adaptive splitting gives the cells of a depth different
+  //shapes, so the points are sorted by their actual size.
+  qsort(hull, count, sizeof(*hull), direct_compare);
+  int points = count;
+  count = 0;
+  for (int i = 0; i < points; i++) {
+    struct direct_point p = hull[i];
+    if (count > 0 && p.size <= hull[count - 1].size) {
+      if (p.value <= hull[count - 1].value) continue;
+      count--;
+    }
+    while (count >= 2 && direct_turn(&hull[count - 2], &hull[count - 1], &p) >= 0.0) {
+      count--;
+    }
+    hull[count++] = p;
+  }
+
+  if (count == 0) {
+    free(hull);
+    return;
+  }
+
+  //Only the part of the hull from the best cell on can be
+  //selected with K >= 0. Past the best cell, values drop 
+  //as sizes grow, and each cell is the largest bound for 
+  //K up to the (negated) slope to the next, larger, cell.
+  int first = 0;
+  for (int i = 1; i < count; i++) {
+    if (hull[i].value >= hull[first].value) first = i;
+  }
+  double best = hull[first].value;
+  double target = best + DIRECT_EPSILON * fabs(best);
+
+  int selected = 0;
+  for (int i = first; i < count; i++) {
+    if (i + 1 < count) {
+      double k = (
+        (hull[i].value - hull[i + 1].value) / 
+        (hull[i + 1].size - hull[i].size)
+      );
+      if (hull[i].value + k * hull[i].size < target) continue;
+    }
+    hull[selected++] = hull[i];
+  }
+
+  //Expanding a cell only adds nodes below it, so the other
+  //selected cells are still in place.
+  for (int i = 0; i < selected; i++) {
+    double child_best = expand_and_remove_node(hull[i].n, state);
+    if (term_cond_met(state, &child_best)) break;
+  }
+  free(hull);
+} /* clogo_direct_select() */
@@ -0,0 +1,183 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/embed.h"
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//M_PI isn't part of strict C11
+#define EMBED_PI 3.14159265358979323846
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* embed_restart
+*
+* Everything a restart thread needs to run.
+***********************************************************/
+struct embed_restart {
+  struct clogo_options opt;//options with this restart's seed
+  struct clogo_result result;
+                           //result of the restart
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* embed_random
+*
+* Returns a uniform random number in (0, 1) and advances 
+* the generator (splitmix64). A private generator keeps 
+* projections identical across platforms and threads.
+***********************************************************/
+static double embed_random(
+  uint64_t *s              //generator state
+)
+{
+  uint64_t z = (*s += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return ((z >> 11) + 0.5) / 9007199254740992.0;
+} /* embed_random() */
+
+/***********************************************************
+* embed_projection
+*
+* Fills `matrix` (embed_dim rows of DIM entries) with the 
+* standard normal random projection for the given seed.
+***********************************************************/
+void embed_projection(
+  int embed_dim,           //number of rows
+  unsigned seed,           //seed of the projection
+  double *matrix           //output projection matrix
+)
+{
+  uint64_t s = seed;
+  for (int i = 0; i < embed_dim * DIM; i++) {
+    //Box-Muller transform
+    double u = embed_random(&s), v = embed_random(&s);
+    matrix[i] = sqrt(-2.0 * log(u)) * cos(2.0 * EMBED_PI * v);
+  }
+} /* embed_projection() */
+
+/***********************************************************
+* embed_apply
+*
+* Maps a point through an already generated projection 
+* matrix. See clogo_embed_map.
+***********************************************************/
+void embed_apply(
+  const double *matrix,    //projection matrix
+  int embed_dim,           //number of rows of `matrix`
+  const double *point,     //DIM-dimensional point
+  double *out              //output embed_dim point
+)
+{
+  //The low dimensional box has to be big enough for the
+  //projection to reach most of the original one.
+  double z[DIM];
+  double scale = sqrt((double)DIM);
+  for (int j = 0; j < DIM; j++) z[j] = (2.0 * point[j] - 1.0) * scale;
+
+  for (int i = 0; i < embed_dim; i++) {
+    double x = 0.0;
+    for (int j = 0; j < DIM; j++) x += matrix[i*DIM + j] * z[j];
+    if (x < -1.0) x = -1.0;
+    else if (x > 1.0) x = 1.0;
+    out[i] = (x + 1.0) / 2.0;
+  }
+} /* embed_apply() */
+
+/***********************************************************
+* clogo_embed_map
+*
+* Maps a point of the DIM-dimensional box being partitioned
+* into the `embed_dim`-dimensional input space of the 
+* objective, through the random projection described by the
+* options (REMBO-style). The low dimensional unit box is 
+* scaled to [-sqrt(DIM), sqrt(DIM)], projected, clipped to 
+* [-1, 1] and scaled back to the unit box.
+***********************************************************/
+void clogo_embed_map(
+  const struct clogo_options *opt,
+                           //options holding the embedding
+  const double *point,     //DIM-dimensional point
+  double *out              //output embed_dim point
+)
+{
+  assert(opt->embed_dim > 0);
+  double *matrix = malloc(sizeof(*matrix) * opt->embed_dim * DIM);
+  embed_projection(opt->embed_dim, opt->embed_seed, matrix);
+  embed_apply(matrix, opt->embed_dim, point, out);
+  free(matrix);
+} /* clogo_embed_map() */
+
+/***********************************************************
+* embed_run
+*
+* Thread entry point for a single restart.
+***********************************************************/
+static void * embed_run(
+  void *arg                //embed_restart to run
+)
+{
+  struct embed_restart *r = arg;
+  r->result = clogo_optimize(&r->opt);
+  return NULL;
+} /* embed_run() */
+
+/***********************************************************
+* clogo_embed_restarts
+*
+* Runs `count` independent optimizations, each with its own
+* random embedding (seeds embed_seed, embed_seed+1, ...),
+* on separate threads. `results` receives each result and 
+* `points` (count*embed_dim entries) each best point mapped
+* into the objective's input space. Returns the index of 
+* the best result.
+***********************************************************/
+int clogo_embed_restarts(
+  const struct clogo_options *opt,
+                           //options to run with
+  int count,               //number of embeddings to try
+  struct clogo_result *results,
+                           //output result of each embedding
+  double *points           //output high dimensional points
+)
+{
+  struct embed_restart *r = malloc(sizeof(*r) * count);
+  pthread_t *threads = malloc(sizeof(*threads) * count);
+  for (int i = 0; i < count; i++) {
+    r[i].opt = *opt;
+    r[i].opt.embed_seed = opt->embed_seed + i;
+    int err = pthread_create(&threads[i], NULL, embed_run, &r[i]);
+    assert(err == 0);
+    (void)err;
+  }
+
+  int best = 0;
+  for (int i = 0; i < count; i++) {
+    pthread_join(threads[i], NULL);
+    results[i] = r[i].result;
+    clogo_embed_map(&r[i].opt, results[i].point, &points[i * opt->embed_dim]);
+    if (results[i].value > results[best].value) best = i;
+  }
+
+  free(threads);
+  free(r);
+  return best;
+} /* clogo_embed_restarts() */
@@ -0,0 +1,588 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/expr.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*********************************************************************
+* CONSTANTS
+*********************************************************************/
+//M_PI and M_E aren't part of strict C11
+#define EXPR_PI 3.14159265358979323846
+#define EXPR_E 2.71828182845904523536
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* expr_parser
+*
+* State of a recursive descent parse. Every parse function
+* returns the register holding the value of what it parsed.
+***********************************************************/
+struct expr_parser {
+  const char *text;        //whole expression
+  const char *pos;         //next character to parse
+  struct clogo_expr *e;    //expression being compiled
+  char *error;             //output error message
+  size_t error_size;       //size of `error`
+  bool failed;             //true once an error was found
+};
+
+/***********************************************************
+* expr_function
+*
+* A named function of one argument.
+***********************************************************/
+struct expr_function {
+  const char *name;        //name in expressions
+  enum expr_op op;         //operation it compiles to
+};
+
+static const struct expr_function expr_functions[] = {
+  {"sin", EXPR_SIN}, {"cos", EXPR_COS}, {"tan", EXPR_TAN},
+  {"tanh", EXPR_TANH}, {"exp", EXPR_EXP}, {"log", EXPR_LOG},
+  {"sqrt", EXPR_SQRT}, {"abs", EXPR_ABS}
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* expr_arity
+*
+* Returns the number of register operands of an operation.
+***********************************************************/
+static int expr_arity(
+  enum expr_op op          //operation to examine
+)
+{
+  switch (op) {
+    case EXPR_CONST:
+    case EXPR_VAR:
+      return 0;
+    case EXPR_ADD:
+    case EXPR_SUB:
+    case EXPR_MUL:
+    case EXPR_DIV:
+    case EXPR_POW:
+      return 2;
+    default:
+      return 1;
+  }
+} /* expr_arity() */
+
+/***********************************************************
+* expr_scalar
+*
+* Applies an arithmetic operation to single values. Used to
+* fold constant subexpressions at compile time.
+***********************************************************/
+static double expr_scalar(
+  enum expr_op op,         //operation to apply
+  double a,                //first operand
+  double b                 //second operand
+)
+{
+  switch (op) {
+    case EXPR_NEG: return -a;
+    case EXPR_ADD: return a + b;
+    case EXPR_SUB: return a - b;
+    case EXPR_MUL: return a * b;
+    case EXPR_DIV: return a / b;
+    case EXPR_POW: return pow(a, b);
+    case EXPR_SQUARE: return a * a;
+    case EXPR_SIN: return sin(a);
+    case EXPR_COS: return cos(a);
+    case EXPR_TAN: return tan(a);
+    case EXPR_TANH: return tanh(a);
+    case EXPR_EXP: return exp(a);
+    case EXPR_LOG: return log(a);
+    case EXPR_SQRT: return sqrt(a);
+    case EXPR_ABS: return fabs(a);
+    default: return NAN;
+  }
+} /* expr_scalar() */
+
+/***********************************************************
+* expr_fail
+*
+* Records a parse error at the current position, unless 
+* one was already recorded. Returns a register that is 
+* safe to use as an operand.
+***********************************************************/
+static int expr_fail(
+  struct expr_parser *p,   //current parse
+  const char *what         //description of the problem
+)
+{
+  if (!p->failed) {
+    snprintf(p->error, p->error_size, "%s at column %d", what, 
+             (int)(p->pos - p->text) + 1);
+    p->failed = true;
+  }
+  return 0;
+} /* expr_fail() */
+
+/***********************************************************
+* expr_emit
+*
+* Appends an instruction and returns its register. Opera-
+* tions on constants are folded into a single constant.
+***********************************************************/
+static int expr_emit(
+  struct expr_parser *p,   //current parse
+  enum expr_op op,         //operation
+  int a,                   //first operand
+  int b,                   //second operand
+  double value             //value of EXPR_CONST
+)
+{
+  struct clogo_expr *e = p->e;
+  if (p->failed) return 0;
+
+  int arity = expr_arity(op);
+  bool folds = (
+    arity > 0 && e->code[a].op == EXPR_CONST &&
+    (arity == 1 || e->code[b].op == EXPR_CONST)
+  );
+  if (folds) {
+    value = expr_scalar(op, e->code[a].value, arity == 1 ? 0.0 : e->code[b].value);
+    op = EXPR_CONST;
+  }
+
+  //Only the operands the operation uses tell instructions
+  //apart, so identical ones (like the two x^2 of 
+  //rosenbrock) share a register.
+  struct expr_instr instr = {
+    .op = op,
+    .a = arity > 0 || op == EXPR_VAR ? a : 0,
+    .b = arity > 1 ? b : 0,
+    .value = op == EXPR_CONST ? value : 0.0
+  };
+  for (int i = 0; i < e->count; i++) {
+    const struct expr_instr *c = &e->code[i];
+    if (c->op != instr.op || c->a != instr.a || c->b != instr.b) continue;
+    if (memcmp(&c->value, &instr.value, sizeof(instr.value)) == 0) return i;
+  }
+
+  if (e->count == e->capacity) {
+    e->capacity = e->capacity > 0 ? e->capacity * 2 : 16;
+    e->code = realloc(e->code, sizeof(*e->code) * e->capacity);
+  }
+  e->code[e->count] = instr;
+  return e->count++;
+} /* expr_emit() */
+
+/***********************************************************
+* expr_compact
+*
+* Drops the instructions the result doesn't depend on, like
+* the operands of folded constants and the exponents of 
+* squares, and renumbers the registers of the rest.
+***********************************************************/
+static void expr_compact(
+  struct clogo_expr *e     //expression to compact
+)
+{
+  //Operands always come before the instructions using 
+  //them, so one backward pass finds everything live...
+  bool *live = calloc(e->count, sizeof(*live));
+  int *renamed = malloc(sizeof(*renamed) * e->count);
+  live[e->result] = true;
+  for (int i = e->count - 1; i >= 0; i--) {
+    if (!live[i]) continue;
+    int arity = expr_arity(e->code[i].op);
+    if (arity > 0) live[e->code[i].a] = true;
+    if (arity > 1) live[e->code[i].b] = true;
+  }
+
+  //...and one forward pass moves it down.
+  int count = 0;
+  for (int i = 0; i < e->count; i++) {
+    if (!live[i]) continue;
+    struct expr_instr c = e->code[i];
+    int arity = expr_arity(c.op);
+    if (arity > 0) c.a = renamed[c.a];
+    if (arity > 1) c.b = renamed[c.b];
+    renamed[i] = count;
+    e->code[count++] = c;
+  }
+  e->result = renamed[e->result];
+  e->count = count;
+
+  free(renamed);
+  free(live);
+} /* expr_compact() */
+
+/***********************************************************
+* expr_skip
+*
+* Skips whitespace and returns the next character.
+***********************************************************/
+static char expr_skip(
+  struct expr_parser *p    //current parse
+)
+{
+  while (isspace((unsigned char)*p->pos)) p->pos++;
+  return *p->pos;
+} /* expr_skip() */
+
+static int expr_sum(struct expr_parser *p);
+static int expr_unary(struct expr_parser *p);
+
+/***********************************************************
+* expr_name
+*
+* Parses an input, constant or function call, starting at
+* an identifier.
+***********************************************************/
+static int expr_name(
+  struct expr_parser *p    //current parse
+)
+{
+  const char *start = p->pos;
+  while (isalnum((unsigned char)*p->pos) || *p->pos == '_') p->pos++;
+  size_t len = (size_t)(p->pos - start);
+
+  if (expr_skip(p) == '(') {
+    int count = sizeof(expr_functions) / sizeof(expr_functions[0]);
+    for (int i = 0; i < count; i++) {
+      const struct expr_function *f = &expr_functions[i];
+      if (strlen(f->name) != len || strncmp(f->name, start, len) != 0) continue;
+      p->pos++;
+      int arg = expr_sum(p);
+      if (expr_skip(p) != ')') return expr_fail(p, "expected ')'");
+      p->pos++;
+      return expr_emit(p, f->op, arg, 0, 0.0);
+    }
+    p->pos = start;
+    return expr_fail(p, "unknown function");
+  }
+
+  if (len == 2 && strncmp(start, "pi", 2) == 0) {
+    return expr_emit(p, EXPR_CONST, 0, 0, EXPR_PI);
+  }
+  if (len == 1 && *start == 'e') return expr_emit(p, EXPR_CONST, 0, 0, EXPR_E);
+  if (len == 1 && *start == 'x') return expr_emit(p, EXPR_VAR, 0, 0, 0.0);
+  if (len == 1 && *start == 'y' && DIM > 1) return expr_emit(p, EXPR_VAR, 1, 0, 0.0);
+  if (len >= 2 && *start == 'x') {
+    char *end;
+    long d = strtol(start + 1, &end, 10);
+    if (end == p->pos && d >= 0 && d < DIM) {
+      return expr_emit(p, EXPR_VAR, (int)d, 0, 0.0);
+    }
+  }
+
+  p->pos = start;
+  return expr_fail(p, "unknown name");
+} /* expr_name() */
+
+/***********************************************************
+* expr_primary
+*
+* Parses a number, name or parenthesized expression.
+***********************************************************/
+static int expr_primary(
+  struct expr_parser *p    //current parse
+)
+{
+  char c = expr_skip(p);
+  if (isdigit((unsigned char)c) || c == '.') {
+    char *end;
+    double value = strtod(p->pos, &end);
+    if (end == p->pos) return expr_fail(p, "invalid number");
+    p->pos = end;
+    return expr_emit(p, EXPR_CONST, 0, 0, value);
+  }
+  if (isalpha((unsigned char)c) || c == '_') return expr_name(p);
+  if (c == '(') {
+    p->pos++;
+    int r = expr_sum(p);
+    if (expr_skip(p) != ')') return expr_fail(p, "expected ')'");
+    p->pos++;
+    return r;
+  }
+  return expr_fail(p, c == '\0' ? "unexpected end" : "unexpected character");
+} /* expr_primary() */
+
+/***********************************************************
+* expr_power
+*
+* Parses a power, which is right associative. Squares, by 
+* far the most common power, compile to a multiplication.
+***********************************************************/
+static int expr_power(
+  struct expr_parser *p    //current parse
+)
+{
+  int base = expr_primary(p);
+  if (expr_skip(p) != '^') return base;
+  p->pos++;
+  int exponent = expr_unary(p);
+  if (p->failed) return 0;
+
+  const struct expr_instr *x = &p->e->code[exponent];
+  if (x->op == EXPR_CONST && x->value == 2.0) {
+    return expr_emit(p, EXPR_SQUARE, base, 0, 0.0);
+  }
+  return expr_emit(p, EXPR_POW, base, exponent, 0.0);
+} /* expr_power() */
+
+/***********************************************************
+* expr_unary
+*
+* Parses a power with any number of leading signs.
+***********************************************************/
+static int expr_unary(
+  struct expr_parser *p    //current parse
+)
+{
+  char c = expr_skip(p);
+  if (c == '-') {
+    p->pos++;
+    return expr_emit(p, EXPR_NEG, expr_unary(p), 0, 0.0);
+  }
+  if (c == '+') {
+    p->pos++;
+    return expr_unary(p);
+  }
+  return expr_power(p);
+} /* expr_unary() */
+
+/***********************************************************
+* expr_product
+*
+* Parses a sequence of multiplications and divisions.
+***********************************************************/
+static int expr_product(
+  struct expr_parser *p    //current parse
+)
+{
+  int left = expr_unary(p);
+  for (char c = expr_skip(p); c == '*' || c == '/'; c = expr_skip(p)) {
+    p->pos++;
+    int right = expr_unary(p);
+    left = expr_emit(p, c == '*' ? EXPR_MUL : EXPR_DIV, left, right, 0.0);
+  }
+  return left;
+} /* expr_product() */
+
+/***********************************************************
+* expr_sum
+*
+* Parses a sequence of additions and subtractions.
+***********************************************************/
+static int expr_sum(
+  struct expr_parser *p    //current parse
+)
+{
+  int left = expr_product(p);
+  for (char c = expr_skip(p); c == '+' || c == '-'; c = expr_skip(p)) {
+    p->pos++;
+    int right = expr_product(p);
+    left = expr_emit(p, c == '+' ? EXPR_ADD : EXPR_SUB, left, right, 0.0);
+  }
+  return left;
+} /* expr_sum() */
+
+/***********************************************************
+* clogo_expr_parse
+*
+* Compiles an expression made of numbers, the inputs, the
+* constants pi and e, + - * / ^ (right associative, binding
+* tighter than unary minus), parentheses, and the functions
+* sin, cos, tan, tanh, exp, log, sqrt and abs. Bounds start
+* out as the unit box. Returns false and describes the 
+* problem in `error` if the expression is invalid.
+***********************************************************/
+bool clogo_expr_parse(
+  struct clogo_expr *e,    //output compiled expression
+  const char *text,        //expression to compile
+  char *error,             //output error message
+  size_t error_size        //size of `error`
+)
+{
+  e->code = NULL;
+  e->count = 0;
+  e->capacity = 0;
+  for (int i = 0; i < DIM; i++) {
+    e->lo[i] = 0.0;
+    e->hi[i] = 1.0;
+  }
+
+  struct expr_parser p = {
+    .text = text,
+    .pos = text,
+    .e = e,
+    .error = error,
+    .error_size = error_size,
+    .failed = false
+  };
+  e->result = expr_sum(&p);
+  if (!p.failed && expr_skip(&p) != '\0') expr_fail(&p, "unexpected character");
+  if (p.failed) {
+    clogo_expr_delete(e);
+    return false;
+  }
+  expr_compact(e);
+  return true;
+} /* clogo_expr_parse() */
+
+/***********************************************************
+* clogo_expr_delete
+*
+* Frees a compiled expression.
+***********************************************************/
+void clogo_expr_delete(
+  struct clogo_expr *e     //expression to delete
+)
+{
+  free(e->code);
+  e->code = NULL;
+  e->count = 0;
+  e->capacity = 0;
+} /* clogo_expr_delete() */
+
+/***********************************************************
+* clogo_expr_map
+*
+* Maps a point of the unit box into the bounds of the 
+* expression's inputs.
+***********************************************************/
+void clogo_expr_map(
+  const struct clogo_expr *e,
+                           //expression holding the bounds
+  const double *point,     //point of the unit box
+  double *out              //output point within the bounds
+)
+{
+  for (int i = 0; i < DIM; i++) {
+    out[i] = e->lo[i] + point[i] * (e->hi[i] - e->lo[i]);
+  }
+} /* clogo_expr_map() */
+
+/***********************************************************
+* expr_point
+*
+* Evaluates the expression at a single point, one 
+* instruction at a time. Cheaper than running whole chunks
+* when there are only a few points.
+***********************************************************/
+static double expr_point(
+  const struct clogo_expr *e,
+                           //expression to evaluate
+  const double *in,        //point of the unit box
+  double *regs             //one register per instruction
+)
+{
+  for (int i = 0; i < e->count; i++) {
+    const struct expr_instr *c = &e->code[i];
+    switch (c->op) {
+      case EXPR_CONST:
+        regs[i] = c->value;
+        break;
+      case EXPR_VAR:
+        regs[i] = e->lo[c->a] + in[c->a] * (e->hi[c->a] - e->lo[c->a]);
+        break;
+      default:
+        regs[i] = expr_scalar(c->op, regs[c->a], regs[c->b]);
+        break;
+    }
+  }
+  return regs[e->result];
+} /* expr_point() */
+
+/***********************************************************
+* clogo_expr_eval
+*
+* Evaluates the expression at `count` points of the unit 
+* box (laid out one after the other). Each instruction runs
+* over a whole chunk of points at once.
+***********************************************************/
+void clogo_expr_eval(
+  const struct clogo_expr *e,
+                           //expression to evaluate
+  const double *points,    //points to evaluate at
+  int count,               //number of points
+  double *values           //output value at each point
+)
+{
+  //Registers only need to be as long as the chunks, which
+  //is a single point when the optimizer evaluates one at a
+  //time. Small register files live on the stack, so those
+  //calls don't go through malloc.
+  int chunk = count < EXPR_CHUNK ? count : EXPR_CHUNK;
+  double stack[EXPR_STACK];
+  double *regs = stack;
+  if ((size_t)chunk * e->count > EXPR_STACK) {
+    regs = malloc(sizeof(*regs) * chunk * e->count);
+  }
+
+  //Running every instruction over a chunk only pays off 
+  //once there are enough points to amortize the loops.
+  if (count < EXPR_SCALAR) {
+    for (int j = 0; j < count; j++) values[j] = expr_point(e, &points[j * DIM], regs);
+    if (regs != stack) free(regs);
+    return;
+  }
+
+  //Constants don't change from one chunk to the next.
+  for (int i = 0; i < e->count; i++) {
+    if (e->code[i].op != EXPR_CONST) continue;
+    double *r = &regs[i * chunk];
+    for (int j = 0; j < chunk; j++) r[j] = e->code[i].value;
+  }
+
+  for (int start = 0; start < count; start += chunk) {
+    const double *in = &points[start * DIM];
+    int n = count - start < chunk ? count - start : chunk;
+
+    for (int i = 0; i < e->count; i++) {
+      const struct expr_instr *c = &e->code[i];
+      //An instruction never reads its own register.
+      double *restrict r = &regs[i * chunk];
+      const double *restrict a = &regs[(c->op == EXPR_VAR ? 0 : c->a) * chunk];
+      const double *restrict b = &regs[c->b * chunk];
+
+      switch (c->op) {
+        case EXPR_CONST:
+          break;
+        case EXPR_VAR: {
+          double lo = e->lo[c->a], width = e->hi[c->a] - e->lo[c->a];
+          for (int j = 0; j < n; j++) r[j] = lo + in[j * DIM + c->a] * width;
+          break;
+        }
+        case EXPR_NEG: for (int j = 0; j < n; j++) r[j] = -a[j]; break;
+        case EXPR_ADD: for (int j = 0; j < n; j++) r[j] = a[j] + b[j]; break;
+        case EXPR_SUB: for (int j = 0; j < n; j++) r[j] = a[j] - b[j]; break;
+        case EXPR_MUL: for (int j = 0; j < n; j++) r[j] = a[j] * b[j]; break;
+        case EXPR_DIV: for (int j = 0; j < n; j++) r[j] = a[j] / b[j]; break;
+        case EXPR_POW: for (int j = 0; j < n; j++) r[j] = pow(a[j], b[j]); break;
+        case EXPR_SQUARE: for (int j = 0; j < n; j++) r[j] = a[j] * a[j]; break;
+        case EXPR_SIN: for (int j = 0; j < n; j++) r[j] = sin(a[j]); break;
+        case EXPR_COS: for (int j = 0; j < n; j++) r[j] = cos(a[j]); break;
+        case EXPR_TAN: for (int j = 0; j < n; j++) r[j] = tan(a[j]); break;
+        case EXPR_TANH: for (int j = 0; j < n; j++) r[j] = tanh(a[j]); break;
+        case EXPR_EXP: for (int j = 0; j < n; j++) r[j] = exp(a[j]); break;
+        case EXPR_LOG: for (int j = 0; j < n; j++) r[j] = log(a[j]); break;
+        case EXPR_SQRT: for (int j = 0; j < n; j++) r[j] = sqrt(a[j]); break;
+        case EXPR_ABS: for (int j = 0; j < n; j++) r[j] = fabs(a[j]); break;
+      }
+    }
+
+    const double *result = &regs[e->result * chunk];
+    for (int j = 0; j < n; j++) values[start + j] = result[j];
+  }
+
+  if (regs != stack) free(regs);
+} /* clogo_expr_eval() */
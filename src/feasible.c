@@ -0,0 +1,151 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/feasible.h"
+#include "clogo/clogo_private.h"
+#include "clogo/embed.h"
+#include "clogo/fidelity.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* feasible_check
+*
+* Checks `count` points (DIM entries each, one after the 
+* other) against the constraints, through the batch 
+* variant of the callback if there is one. Points are 
+* mapped into the objective's input space first, since 
+* that's what the constraints are about.
+***********************************************************/
+static void feasible_check(
+  struct clogo_state *state,
+                           //current optimization state
+  double *points,          //points to check
+  int count,               //number of points
+  bool *out                //output feasibility of each point
+)
+{
+  //Convenience alias for the optimization options.
+  const struct clogo_options *opt = state->opt;
+
+  if (opt->feasible == NULL && opt->feasible_batch == NULL) {
+    for (int i = 0; i < count; i++) out[i] = true;
+    return;
+  }
+
+  int dim = DIM;
+  double *inputs = points;
+  if (state->embedding != NULL) {
+    dim = opt->embed_dim;
+    inputs = malloc(sizeof(*inputs) * dim * count);
+    for (int i = 0; i < count; i++) {
+      embed_apply(state->embedding, dim, &points[i*DIM], &inputs[i*dim]);
+    }
+  }
+
+  if (opt->feasible_batch != NULL) {
+    (*opt->feasible_batch)(inputs, count, out);
+  } else {
+    for (int i = 0; i < count; i++) out[i] = (*opt->feasible)(&inputs[i*dim]);
+  }
+  if (inputs != points) free(inputs);
+
+  for (int i = 0; i < count; i++) {
+    if (out[i]) state->feasible++;
+    else state->infeasible++;
+  }
+} /* feasible_check() */
+
+/***********************************************************
+* feasible_point
+*
+* Returns true if the given point satisfies the constraints
+* of the options (always, if there are none), and accounts
+* for the check in the state.
+***********************************************************/
+bool feasible_point(
+  struct clogo_state *state,
+                           //current optimization state
+  double *point            //point to check
+)
+{
+  bool ok;
+  feasible_check(state, point, 1, &ok);
+  return ok;
+} /* feasible_point() */
+
+/***********************************************************
+* feasible_children
+*
+* Checks the centers of all `k` children a node would be 
+* split into along `split_dim` against the constraints, as
+* a single batch, and stores whether each one is feasible 
+* in `out`. The middle child shares its parent's center, so
+* it isn't checked again.
+***********************************************************/
+void feasible_children(
+  const struct node *parent,
+                           //node about to be split
+  int split_dim,           //dimension to split along
+  struct clogo_state *state,
+                           //current optimization state
+  bool *out                //output feasibility of each child
+)
+{
+  int k = split_count(state->opt, parent->depth);
+  int mid = k / 2;
+  double width = parent->sizes[split_dim] / k;
+
+  //Centers of every child but the middle one.
+  double *centers = malloc(sizeof(*centers) * DIM * (k - 1));
+  bool *ok = malloc(sizeof(*ok) * (k - 1));
+  int count = 0;
+  for (int i = 0; i < k; i++) {
+    if (i == mid) continue;
+    double *c = &centers[count*DIM];
+    calculate_center(parent, c);
+    c[split_dim] = parent->edges[split_dim] + width * i + width/2.0;
+    count++;
+  }
+  feasible_check(state, centers, count, ok);
+
+  count = 0;
+  for (int i = 0; i < k; i++) {
+    out[i] = i == mid ? !parent->infeasible : ok[count++];
+  }
+  free(ok);
+  free(centers);
+} /* feasible_children() */
+
+/***********************************************************
+* feasible_mark
+*
+* Fills a node whose center violates the constraints with
+* the penalty value of the options instead of sampling it.
+***********************************************************/
+void feasible_mark(
+  struct node *n,          //node to mark
+  struct clogo_state *state//current optimization state
+)
+{
+  const struct clogo_options *opt = state->opt;
+  n->value = opt->infeasible_value;
+  n->mean = opt->infeasible_value;
+  //Nothing is learned by sampling the cell again, at any 
+  //fidelity or any number of times.
+  n->evals = opt->noise_k;
+  n->fidelity = fidelity_full(opt);
+  n->estimated = false;
+  //There's no real sample to bound the cell's neighbours 
+  //with, so the surrogate must never skip them because of 
+  //it.
+  n->anchor_value = INFINITY;
+  n->anchor_dist = 0.0;
+  n->infeasible = true;
+} /* feasible_mark() */
@@ -0,0 +1,409 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/fidelity.h"
+#include "clogo/batch.h"
+#include "clogo/clogo_private.h"
+#include "clogo/embed.h"
+#include "clogo/grid.h"
+#include "clogo/latency.h"
+#include "clogo/noise.h"
+#include "clogo/table.h"
+#include "clogo/trace.h"
+#include "clogo/vector.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* source
+*
+* Where the value of a point in a batch comes from.
+***********************************************************/
+enum source {
+  SOURCE_FRESH,            //the objective itself
+  SOURCE_REPLAY,           //the replayed trace
+  SOURCE_COPY,             //a shared table, or another point
+                           //of the batch
+  SOURCE_WAIT,             //a shared table, once another 
+                           //optimization is done with it
+  SOURCE_DUPLICATE         //an evaluation this optimization
+                           //already paid for
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* fidelity_full
+*
+* Returns the fidelity level that corresponds with the real
+* objective function.
+***********************************************************/
+int fidelity_full(
+  const struct clogo_options *opt
+                           //problem definition
+)
+{
+  return opt->fidelities ? opt->fidelity_count : 0;
+} /* fidelity_full() */
+
+/***********************************************************
+* fidelity_level
+*
+* Returns the fidelity level a cell at the given depth
+* should be sampled at, according to the policy in the 
+* options structure.
+***********************************************************/
+int fidelity_level(
+  const struct clogo_options *opt,
+                           //problem definition
+  int depth                //depth of the cell to sample
+)
+{
+  int full = fidelity_full(opt);
+  if (opt->fidelity_policy == NULL) return full;
+
+  //Clip whatever the policy decides to the valid levels.
+  int level = (*opt->fidelity_policy)(depth);
+  if (level < 0) level = 0;
+  else if (level > full) level = full;
+  return level;
+} /* fidelity_level() */
+
+/***********************************************************
+* fidelity_call
+*
+* Calls the objective of the given fidelity level on 
+* `count` inputs of `dim` entries laid out one after the 
+* other. A vector-valued objective is scalarized, and the
+* real objective's batch version is preferred; otherwise 
+* the inputs are spread over the worker threads requested
+* in the options. If the state has a latency model, those
+* calls are timed and handed out longest expected first.
+* Aborts if there's no objective for the level.
+***********************************************************/
+static void fidelity_call(
+  const struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  const double *points,    //point in the box of each input
+  double *inputs,          //inputs of the objective
+  int dim,                 //number of entries per input
+  int count,               //number of inputs
+  double *values,          //output value of each input
+  double *seconds          //output time each input took, 
+                           //left alone if not timed
+)
+{
+  const struct clogo_options *opt = state->opt;
+  if (level >= fidelity_full(opt) && opt->fn_vector != NULL) {
+    vector_evaluate(opt, inputs, dim, count, values);
+    return;
+  }
+  if (level >= fidelity_full(opt) && opt->fn_batch != NULL) {
+    (*opt->fn_batch)(inputs, count, values);
+    return;
+  }
+
+  double (*fn)(double *) = (
+    level < fidelity_full(opt) ? opt->fidelities[level].fn : opt->fn
+  );
+  //Without an objective (when replaying a trace that 
+  //diverged, say), there's nothing to fall back on, and 
+  //carrying on with made up values would silently corrupt
+  //the search.
+  if (fn == NULL) {
+    fprintf(stderr, "clogo: no objective to evaluate fidelity level %d\n", level);
+    abort();
+  }
+  if (state->latency == NULL) {
+    batch_map(fn, inputs, dim, count, opt->workers, NULL, values, NULL);
+    return;
+  }
+
+  int *order = malloc(sizeof(*order) * count);
+  latency_order(state->latency, points, count, order);
+  batch_map(fn, inputs, dim, count, opt->workers, order, values, seconds);
+  free(order);
+} /* fidelity_call() */
+
+/***********************************************************
+* fidelity_evaluate
+*
+* Evaluates the objective at the given fidelity level and
+* point, and accounts for the sample and its cost in the
+* state.
+***********************************************************/
+double fidelity_evaluate(
+  struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  double *point            //point to evaluate
+)
+{
+  double value;
+  fidelity_evaluate_batch(state, level, point, 1, &value, NULL);
+  return value;
+} /* fidelity_evaluate() */
+
+/***********************************************************
+* fidelity_evaluate_batch
+*
+* Evaluates the objective at the given fidelity level and 
+* `count` points (laid out one after the other), and 
+* accounts for the samples and their cost in the state. 
+* This is the only place objective functions are called, 
+* so it's also where traces are recorded/replayed, shared 
+* evaluation tables are consulted and points are snapped to
+* the resolution of the inputs. The points that actually
+* need the objective are handed to it all at once, and 
+* timed to train the latency model if there is one.
+***********************************************************/
+void fidelity_evaluate_batch(
+  struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  double *points,          //points to evaluate
+  int count,               //number of points
+  double *values,          //output value of each point
+  double *seconds          //output time the objective took
+                           //on each point; NULL=not needed
+)
+{
+  //Convenience alias for the optimization options.
+  const struct clogo_options *opt = state->opt;
+  struct clogo_trace *trace = opt->trace;
+  int full = fidelity_full(opt);
+  double cost = level < full ? opt->fidelities[level].cost : 1.0;
+
+  //If another optimization already evaluated a point, or 
+  //this one did at the same grid point, there's no need to
+  //do it again. Unless the objective is noisy, in which 
+  //case evaluating it again is the point.
+  struct clogo_table *dedup = opt->noise_k > 0 ? NULL : state->dedup;
+  struct clogo_table *table = opt->noise_k > 0 ? NULL : opt->table;
+
+  //Points the objective can't tell apart are evaluated at
+  //the center of their grid step.
+  double *snapped = NULL;
+  if (opt->resolution != NULL) {
+    snapped = malloc(sizeof(*snapped) * DIM * count);
+    for (int i = 0; i < count; i++) {
+      grid_snap(opt, &points[i * DIM], &snapped[i * DIM]);
+    }
+    points = snapped;
+  }
+
+  //Find out where the value of each point comes from. 
+  //Points repeated within the batch take the value of 
+  //their first occurrence, which holds any claim on the 
+  //tables (claiming them again would wait forever).
+  enum source *sources = malloc(sizeof(*sources) * count);
+  int *first = malloc(sizeof(*first) * count);
+  int *fresh = malloc(sizeof(*fresh) * count);
+  int fresh_count = 0;
+  for (int i = 0; i < count; i++) {
+    double *point = &points[i * DIM];
+    values[i] = NAN;
+    if (seconds != NULL) seconds[i] = 0.0;
+    first[i] = i;
+    if (dedup != NULL || table != NULL) {
+      for (int j = 0; j < i && first[i] == i; j++) {
+        bool repeated = (
+          first[j] == j && sources[j] != SOURCE_DUPLICATE &&
+          memcmp(&points[j * DIM], point, sizeof(*point) * DIM) == 0
+        );
+        if (repeated) first[i] = j;
+      }
+    }
+
+    if (first[i] != i) {
+      sources[i] = dedup != NULL ? SOURCE_DUPLICATE : SOURCE_COPY;
+      continue;
+    }
+    //Nobody else uses the private table, so its points are
+    //never busy.
+    enum table_status status = (
+      dedup != NULL ? table_claim(dedup, level, point, &values[i]) : TABLE_CLAIMED
+    );
+    assert(status != TABLE_BUSY);
+    if (status == TABLE_FOUND) {
+      sources[i] = SOURCE_DUPLICATE;
+      continue;
+    }
+    if (
+      trace != NULL && trace->mode == TRACE_REPLAY &&
+      trace_replay(trace, level, point, &values[i])
+    ) {
+      sources[i] = SOURCE_REPLAY;
+      continue;
+    }
+    status = (
+      table != NULL ? table_claim(table, level, point, &values[i]) : TABLE_CLAIMED
+    );
+    if (status == TABLE_FOUND) {
+      sources[i] = SOURCE_COPY;
+    } else if (status == TABLE_BUSY) {
+      sources[i] = SOURCE_WAIT;
+    } else {
+      sources[i] = SOURCE_FRESH;
+      fresh[fresh_count++] = i;
+    }
+  }
+
+  //Objectives of embedded problems don't see the points 
+  //being partitioned, but their random projections.
+  if (fresh_count > 0) {
+    int dim = state->embedding != NULL ? opt->embed_dim : DIM;
+    double *inputs = malloc(sizeof(*inputs) * dim * fresh_count);
+    double *fresh_points = malloc(sizeof(*fresh_points) * DIM * fresh_count);
+    double *results = malloc(sizeof(*results) * fresh_count);
+    double *times = malloc(sizeof(*times) * fresh_count);
+    for (int f = 0; f < fresh_count; f++) {
+      double *point = &points[fresh[f] * DIM];
+      memcpy(&fresh_points[f * DIM], point, sizeof(*point) * DIM);
+      if (state->embedding != NULL) {
+        embed_apply(state->embedding, opt->embed_dim, point, &inputs[f * dim]);
+      } else {
+        memcpy(&inputs[f * dim], point, sizeof(*point) * DIM);
+      }
+      results[f] = NAN;
+      times[f] = 0.0;
+    }
+    fidelity_call(state, level, fresh_points, inputs, dim, fresh_count, results, times);
+
+    //Only the full objective's times are learned: cheaper 
+    //fidelities take time of their own.
+    for (int f = 0; f < fresh_count; f++) {
+      values[fresh[f]] = results[f];
+      if (seconds != NULL) seconds[fresh[f]] = times[f];
+      if (state->latency != NULL && level >= full && times[f] > 0.0) {
+        latency_observe(state->latency, &fresh_points[f * DIM], times[f]);
+      }
+    }
+    free(times);
+    free(results);
+    free(fresh_points);
+    free(inputs);
+  }
+
+  //Only wait for the points other optimizations are busy 
+  //with once every claim of this one is filled; waiting 
+  //while holding claims deadlocks two optimizations that 
+  //each need a point the other claimed.
+  for (int f = 0; f < fresh_count; f++) {
+    int i = fresh[f];
+    if (table != NULL) {
+      table_fill(table, level, &points[i * DIM], values[i], level >= full);
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    if (sources[i] == SOURCE_WAIT) values[i] = table_wait(table, level, &points[i * DIM]);
+  }
+
+  for (int i = 0; i < count; i++) {
+    double *point = &points[i * DIM];
+    if (first[i] != i) values[i] = values[first[i]];
+
+    //Values found in the private table were already paid
+    //for by this optimization.
+    if (sources[i] == SOURCE_DUPLICATE) {
+      state->duplicates++;
+      continue;
+    }
+
+    if (first[i] == i && dedup != NULL) {
+      table_fill(dedup, level, point, values[i], level >= full);
+    }
+
+    if (trace != NULL && trace->mode == TRACE_RECORD) {
+      trace_record(trace, level, point, values[i]);
+    }
+
+    state->cost += cost;
+    state->samples++;
+    if (state->fidelity_samples) state->fidelity_samples[level]++;
+  }
+
+  free(fresh);
+  free(first);
+  free(sources);
+  free(snapped);
+} /* fidelity_evaluate_batch() */
+
+/***********************************************************
+* fidelity_evaluate_repeated
+*
+* Evaluates the objective `count` times at the same point,
+* as fidelity_evaluate would, in a single batch.
+***********************************************************/
+void fidelity_evaluate_repeated(
+  struct clogo_state *state,
+                           //current optimization state
+  int level,               //fidelity level to use
+  double *point,           //point to evaluate
+  int count,               //number of evaluations
+  double *values           //output value of each evaluation
+)
+{
+  double *points = malloc(sizeof(*points) * DIM * count);
+  for (int i = 0; i < count; i++) {
+    memcpy(&points[i * DIM], point, sizeof(*point) * DIM);
+  }
+  fidelity_evaluate_batch(state, level, points, count, values, NULL);
+  free(points);
+} /* fidelity_evaluate_repeated() */
+
+/***********************************************************
+* fidelity_refine
+*
+* If the given node was sampled at a coarse fidelity, 
+* resample it using the real objective function and return 
+* true. Returns false if the node's value was already 
+* sampled at full fidelity.
+***********************************************************/
+bool fidelity_refine(
+  struct node *n,          //node to refine
+  struct clogo_state *state//current optimization state
+)
+{
+  int full = fidelity_full(state->opt);
+  if (n->fidelity >= full) return false;
+
+  //Estimated nodes are refined by a real sample as well, 
+  //since their anchor was coarse in the first place.
+  double center[DIM], value;
+  calculate_center(n, center);
+  fidelity_evaluate_batch(state, full, center, 1, &value, &n->latency);
+  noise_set(n, value, 1, state);
+  n->fidelity = full;
+  n->anchor_value = n->mean;
+  n->anchor_dist = 0.0;
+  n->estimated = false;
+  return true;
+} /* fidelity_refine() */
+
+/***********************************************************
+* init_fidelity_accounting
+*
+* Allocates the per-fidelity sample counters of a freshly
+* created state.
+***********************************************************/
+void init_fidelity_accounting(
+  struct clogo_state *state//state to initialize
+)
+{
+  int levels = fidelity_full(state->opt) + 1;
+  state->fidelity_samples = calloc(levels, sizeof(*state->fidelity_samples));
+} /* init_fidelity_accounting() */
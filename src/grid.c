@@ -0,0 +1,65 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/grid.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* grid_snap
+*
+* Snaps a point to the center of the grid step it falls in,
+* along every dimension with a resolution. Dimensions 
+* without one are copied as they are.
+***********************************************************/
+void grid_snap(
+  const struct clogo_options *opt,
+                           //options holding the resolution
+  const double *point,     //point to snap
+  double *out              //output snapped point
+)
+{
+  for (int i = 0; i < DIM; i++) {
+    double res = opt->resolution[i];
+    if (res <= 0.0) {
+      out[i] = point[i];
+      continue;
+    }
+
+    //The upper edge of the box belongs to the last step.
+    double step = floor(point[i] / res);
+    if ((step + 0.5) * res > 1.0) step -= 1.0;
+    out[i] = (step + 0.5) * res;
+  }
+} /* grid_snap() */
+
+/***********************************************************
+* grid_split_dim
+*
+* Returns the dimension a cell should be split along: the
+* widest one that is still wider than the resolution. 
+* Returns -1 if the cell is no wider than the resolution 
+* along any dimension and shouldn't be split at all.
+***********************************************************/
+int grid_split_dim(
+  const struct clogo_options *opt,
+                           //options holding the resolution
+  const struct node *n     //cell to split
+)
+{
+  //Ties go to the dimension cycling with depth, which 
+  //keeps the cells of the unit box uniformly shaped.
+  int best = -1;
+  for (int j = 0; j < DIM; j++) {
+    int d = (n->depth + j) % DIM;
+    if (opt->resolution != NULL && n->sizes[d] <= opt->resolution[d]) continue;
+    if (best < 0 || n->sizes[d] > n->sizes[best]) best = d;
+  }
+  return best;
+} /* grid_split_dim() */
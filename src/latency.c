@@ -0,0 +1,149 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/latency.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* latency_entry
+*
+* A point to be evaluated, along with how long it's 
+* expected to take.
+***********************************************************/
+struct latency_entry {
+  double expected;         //expected time, in seconds
+  int index;               //index of the point
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* latency_cell
+*
+* Fills `cell` with the lattice coordinates of the cell the
+* given point falls in, which key the cell in the model.
+***********************************************************/
+static void latency_cell(
+  const double *point,     //point in the unit box
+  double *cell             //output coordinates (DIM)
+)
+{
+  for (int i = 0; i < DIM; i++) {
+    double c = floor(point[i] * LATENCY_GRID);
+    if (c < 0.0) c = 0.0;
+    else if (c >= LATENCY_GRID) c = LATENCY_GRID - 1;
+    cell[i] = c;
+  }
+} /* latency_cell() */
+
+/***********************************************************
+* latency_init
+*
+* Allocates the latency model of a freshly created state,
+* if the options ask for cost-aware dispatch.
+***********************************************************/
+void latency_init(
+  struct clogo_state *state
+)
+{
+  if (!state->opt->latency_order) return;
+
+  state->latency = malloc(sizeof(*state->latency));
+  clogo_table_init(&state->latency->cells, LATENCY_BUCKETS, false);
+  state->latency->mean = 0.0;
+  state->latency->observed = 0;
+} /* latency_init() */
+
+/***********************************************************
+* latency_delete
+*
+* Frees the latency model of a state, if it has one.
+***********************************************************/
+void latency_delete(
+  struct clogo_state *state
+)
+{
+  if (state->latency == NULL) return;
+  clogo_table_delete(&state->latency->cells);
+  free(state->latency);
+  state->latency = NULL;
+} /* latency_delete() */
+
+/***********************************************************
+* latency_observe
+*
+* Adds the measured time of an evaluation at the given 
+* point to the model.
+***********************************************************/
+void latency_observe(
+  struct clogo_latency *l,
+  const double *point,
+  double seconds
+)
+{
+  //The first observation of a cell (or of the model) 
+  //stands for it on its own.
+  double cell[DIM], average;
+  latency_cell(point, cell);
+  if (table_claim(&l->cells, 0, cell, &average) == TABLE_FOUND) {
+    average += LATENCY_DECAY * (seconds - average);
+  } else {
+    average = seconds;
+  }
+  table_fill(&l->cells, 0, cell, average, false);
+  l->mean = l->observed > 0 ? l->mean + LATENCY_DECAY * (seconds - l->mean) : seconds;
+  l->observed++;
+} /* latency_observe() */
+
+/***********************************************************
+* latency_compare
+*
+* qsort comparator putting the longest expected evaluations
+* first, and ties in their original order.
+***********************************************************/
+static int latency_compare(
+  const void *a,
+  const void *b
+)
+{
+  const struct latency_entry *x = a, *y = b;
+  if (x->expected != y->expected) return x->expected < y->expected ? 1 : -1;
+  return (x->index > y->index) - (x->index < y->index);
+} /* latency_compare() */
+
+/***********************************************************
+* latency_order
+*
+* Fills `order` with the indices of `count` points, longest
+* expected evaluation first.
+***********************************************************/
+void latency_order(
+  struct clogo_latency *l,
+  const double *points,
+  int count,
+  int *order
+)
+{
+  struct latency_entry *entries = malloc(sizeof(*entries) * count);
+  for (int i = 0; i < count; i++) {
+    double cell[DIM];
+    latency_cell(&points[i * DIM], cell);
+    if (!table_lookup(&l->cells, 0, cell, &entries[i].expected)) {
+      entries[i].expected = l->mean;
+    }
+    entries[i].index = i;
+  }
+  qsort(entries, count, sizeof(*entries), latency_compare);
+  for (int i = 0; i < count; i++) order[i] = entries[i].index;
+  free(entries);
+} /* latency_order() */
@@ -0,0 +1,196 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/local.h"
+#include "clogo/clogo_private.h"
+#include "clogo/feasible.h"
+#include "clogo/fidelity.h"
+
+#include <math.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* local_enabled
+*
+* Returns true if the given node should be refined by a 
+* local search.
+***********************************************************/
+bool local_enabled(
+  const struct clogo_state *state,
+                           //current optimization state
+  const struct node *n     //candidate node
+)
+{
+  //Convenience alias for the optimization options.
+  const struct clogo_options *opt = state->opt;
+
+  return (
+    opt->local_depth > 0 &&
+    n->depth >= opt->local_depth &&
+    !n->refined &&
+    !n->estimated &&
+    !n->pending &&
+    !n->infeasible &&
+    n->mean > state->local_best_value
+  );
+} /* local_enabled() */
+
+/***********************************************************
+* local_can_sample
+*
+* Returns true if a local search that has used `used` of
+* its `max` samples may take another one without exceeding
+* its own or the optimization's budget.
+***********************************************************/
+static bool local_can_sample(
+  const struct clogo_state *state,
+                           //current optimization state
+  int used,                //samples used by the search
+  int max                  //sample limit of the search
+)
+{
+  return used < max && !budget_spent(state);
+} /* local_can_sample() */
+
+/***********************************************************
+* local_evaluate
+*
+* Clips the given point into the cell, evaluates it with 
+* the real objective and returns the value. Counts the 
+* sample against the budget of the local search. Points 
+* violating the constraints get the penalty value instead.
+***********************************************************/
+static double local_evaluate(
+  const struct node *n,    //cell being searched
+  double *point,           //point to clip and evaluate
+  struct clogo_state *state,
+                           //current optimization state
+  int *used                //samples used by the search
+)
+{
+  for (int i = 0; i < DIM; i++) {
+    double lo = n->edges[i], hi = n->edges[i] + n->sizes[i];
+    if (point[i] < lo) point[i] = lo;
+    else if (point[i] > hi) point[i] = hi;
+  }
+  (*used)++;
+  if (!feasible_point(state, point)) return state->opt->infeasible_value;
+  return fidelity_evaluate(state, fidelity_full(state->opt), point);
+} /* local_evaluate() */
+
+/***********************************************************
+* local_refine
+*
+* Runs a Nelder-Mead search inside the bounds of the given
+* cell, starting from its center. Samples share the budget
+* of the optimization, and the best point found is recorded
+* in the state as the best-known value.
+***********************************************************/
+void local_refine(
+  struct node *n,          //cell to search in
+  struct clogo_state *state//current optimization state
+)
+{
+  //Convenience alias for the optimization options.
+  const struct clogo_options *opt = state->opt;
+  //Sample budget of this search.
+  int max = opt->local_max > 0 ? opt->local_max : LOCAL_DEFAULT_MAX;
+  int used = 0;
+
+  //Initial simplex: the center of the cell, whose value is
+  //already known, plus one vertex a quarter of the cell 
+  //away along each dimension.
+  double x[DIM+1][DIM], f[DIM+1];
+  calculate_center(n, x[0]);
+  f[0] = n->mean;
+  for (int v = 1; v <= DIM; v++) {
+    for (int i = 0; i < DIM; i++) x[v][i] = x[0][i];
+    x[v][v-1] += n->sizes[v-1] / 4.0;
+    if (local_can_sample(state, used, max)) {
+      f[v] = local_evaluate(n, x[v], state, &used);
+    } else {
+      f[v] = -INFINITY;
+    }
+  }
+  n->refined = true;
+  state->local_runs++;
+
+  while (local_can_sample(state, used, max)) {
+    //Order the simplex from best (highest) to worst value.
+    for (int a = 1; a <= DIM; a++) {
+      for (int b = a; b > 0 && f[b] > f[b-1]; b--) {
+        double tf = f[b]; f[b] = f[b-1]; f[b-1] = tf;
+        for (int i = 0; i < DIM; i++) {
+          double t = x[b][i]; x[b][i] = x[b-1][i]; x[b-1][i] = t;
+        }
+      }
+    }
+    if (term_cond_met(state, &f[0])) break;
+
+    //Stop once the simplex has shrunk to nothing relative
+    //to the cell.
+    bool converged = true;
+    for (int v = 1; v <= DIM; v++) {
+      for (int i = 0; i < DIM; i++) {
+        if (fabs(x[v][i] - x[0][i]) > LOCAL_MIN_STEP * n->sizes[i]) {
+          converged = false;
+        }
+      }
+    }
+    if (converged) break;
+
+    //Centroid of every vertex but the worst.
+    double c[DIM] = {0};
+    for (int v = 0; v < DIM; v++) {
+      for (int i = 0; i < DIM; i++) c[i] += x[v][i] / DIM;
+    }
+
+    //Reflect the worst vertex through the centroid...
+    double r[DIM];
+    for (int i = 0; i < DIM; i++) r[i] = c[i] + (c[i] - x[DIM][i]);
+    double fr = local_evaluate(n, r, state, &used);
+
+    if (fr > f[0] && local_can_sample(state, used, max)) {
+      //...and try going further if that's the new best...
+      double e[DIM];
+      for (int i = 0; i < DIM; i++) e[i] = c[i] + 2.0 * (c[i] - x[DIM][i]);
+      double fe = local_evaluate(n, e, state, &used);
+      bool expand = fe > fr;
+      for (int i = 0; i < DIM; i++) x[DIM][i] = expand ? e[i] : r[i];
+      f[DIM] = expand ? fe : fr;
+    } else if (fr > f[DIM-1]) {
+      //...or just keep it if it beats the second worst...
+      for (int i = 0; i < DIM; i++) x[DIM][i] = r[i];
+      f[DIM] = fr;
+    } else if (local_can_sample(state, used, max)) {
+      //...otherwise contract towards the centroid, or
+      //shrink everything towards the best vertex.
+      double k[DIM];
+      for (int i = 0; i < DIM; i++) k[i] = c[i] + 0.5 * (x[DIM][i] - c[i]);
+      double fk = local_evaluate(n, k, state, &used);
+      if (fk > f[DIM]) {
+        for (int i = 0; i < DIM; i++) x[DIM][i] = k[i];
+        f[DIM] = fk;
+      } else {
+        for (int v = 1; v <= DIM && local_can_sample(state, used, max); v++) {
+          for (int i = 0; i < DIM; i++) {
+            x[v][i] = x[0][i] + 0.5 * (x[v][i] - x[0][i]);
+          }
+          f[v] = local_evaluate(n, x[v], state, &used);
+        }
+      }
+    }
+  }
+
+  //Feed the best vertex back as the best-known value.
+  for (int v = 0; v <= DIM; v++) {
+    if (f[v] > state->local_best_value) {
+      state->local_best_value = f[v];
+      for (int i = 0; i < DIM; i++) state->local_best_point[i] = x[v][i];
+    }
+  }
+} /* local_refine() */
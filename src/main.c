@@ -2,8 +2,13 @@
 * INCLUDES
 *********************************************************************/
 #include "clogo/clogo.h"
+#include "clogo/expr.h"
+#include "clogo/testfn.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
 #include <math.h>
 #include <assert.h>
 
@@ -24,51 +29,45 @@
 #define FN rosenbrock_2
 
 
+/*********************************************************************
+* GLOBALS
+*********************************************************************/
+//Objective compiled from the command line
+static struct clogo_expr expr_objective;
+
+
 /*********************************************************************
 * FUNCTIONS
 *********************************************************************/
 
 /***********************************************************
-* rosenbrock_2
+* fn_expr
 *
-* 2D rosenbrock function - maps [0,1] to [-5,10].
+* Objective compiled from the command line.
 ***********************************************************/
-double rosenbrock_2(
+double fn_expr(
   double *i
-) 
-{
-  double x = i[0], y = i[1];
-  double min = -5.0;
-  double max = 10.0;
-  x = min + x * (max - min);
-  y = min + y * (max - min);
-  return -(100.0 * pow(y - x * x, 2.0) + pow(x * x - 1.0, 2.0));
-} /* rosenbrock_2() */
-
-/***********************************************************
-* sin_helper
-*
-* Convenience function for calculating sin_X.
-***********************************************************/
-double sin_helper(
-  double x
 )
 {
-  return (sin(13.0 * x)*sin(27.0 * x) + 1.0) / 2;
-} /* sin_helper() */
+  double value;
+  clogo_expr_eval(&expr_objective, i, 1, &value);
+  return value;
+} /* fn_expr() */
 
 /***********************************************************
-* sin_2
+* fn_expr_batch
 *
-* 2D sin test function.
+* Objective compiled from the command line, evaluated at a
+* number of points at once.
 ***********************************************************/
-double sin_2(
-  double *i
+void fn_expr_batch(
+  double *i,
+  int count,
+  double *values
 )
 {
-  double x = i[0], y = i[1];
-  return sin_helper(x) * sin_helper(y);
-} /* sin_2() */
+  clogo_expr_eval(&expr_objective, i, count, values);
+} /* fn_expr_batch() */
 
 /***********************************************************
 * hmax
@@ -77,19 +76,21 @@ double sin_2(
 * consider given a certain number of function evaluations.
 ***********************************************************/
 double hmax(
-  int n                    //current number of function eval
+  int64_t n                //current number of function eval
 )
 {
   return sqrt((double)n);
 } /* hmax() */
 
 /***********************************************************
-* logo_schedule
+* logo_next_w
 *
-* w schedule for the LOGO algorithm.
+* Steps through the LOGO ladder of w values: up if the best
+* value improved, down otherwise.
 ***********************************************************/
-int logo_schedule(
-  const struct clogo_state *state
+int logo_next_w(
+  int current,             //current w value
+  bool improved            //true if the best value improved
 )
 {
   static const int w[] = {3, 4, 5, 6, 8, 30};
@@ -97,7 +98,7 @@ int logo_schedule(
   int w_cnt = sizeof(w)/sizeof(w[0]);
   int j = -1;
   for (int i = 0; i < w_cnt; i++) {
-    if (state->w == w[i]) {
+    if (current == w[i]) {
       j = i;
       break;
     }
@@ -105,19 +106,26 @@ int logo_schedule(
   assert(j != -1);
 
   //Decide index of next w value
-  int k = j;
-  double new_best = state_best_value(state); 
-  if (new_best > state->last_best_value) {
-    k++;
-  } else {
-    k--;
-  }
+  int k = improved ? j+1 : j-1;
 
   //Clip index
   if (k < 0) k = 0;
   else if (k >= w_cnt) k = w_cnt-1;
 
   return w[k];
+} /* logo_next_w() */
+
+/***********************************************************
+* logo_schedule
+*
+* w schedule for the LOGO algorithm.
+***********************************************************/
+int logo_schedule(
+  const struct clogo_state *state
+)
+{
+  double new_best = state_best_value(state); 
+  return logo_next_w(state->w, new_best > state->last_best_value);
 } /* logo_schedule() */
 
 /***********************************************************
@@ -143,8 +151,11 @@ void display_result(
   struct clogo_result *result
 )
 {
-  printf("samples: %d\t error: %e\t point: %f/%f\n",
-         result->samples, FN_MAX - result->value,
+  printf("samples: %" PRId64 "\t cost: %.1f\t estimates: %" PRId64 "\t"
+         " error: %e\t "
+         "point: %f/%f\n",
+         result->samples, result->cost, result->estimates,
+         FN_MAX - result->value,
          result->point[0], result->point[1]);
 } /* display_result() */
 
@@ -188,11 +199,122 @@ struct clogo_options test_logo()
   return opt;
 } /* test_logo() */
 
+/***********************************************************
+* run_expr
+*
+* Optimizes an objective given on the command line:
+*   cl -f EXPR [--bounds LO,HI | --bounds LO0,HI0,LO1,HI1]
+*      [--max N] [--optimum VALUE] [--status PATH]
+* Without an optimum, the whole budget is spent. With a 
+* status path, progress can be followed with clstatus.
+***********************************************************/
+int run_expr(
+  int argc,
+  char **argv
+)
+{
+  const char *text = NULL;
+  const char *bounds = NULL;
+  struct clogo_options opt = test_soo();
+  opt.fn_optimum = INFINITY;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (value == NULL) {
+      fprintf(stderr, "missing value for %s\n", arg);
+      return 1;
+    }
+    i++;
+
+    //Numbers have to be numbers all the way through.
+    char *end = NULL;
+    if (strcmp(arg, "-f") == 0) text = value;
+    else if (strcmp(arg, "--bounds") == 0) bounds = value;
+    else if (strcmp(arg, "--max") == 0) opt.max = strtoll(value, &end, 10);
+    else if (strcmp(arg, "--optimum") == 0) opt.fn_optimum = strtod(value, &end);
+    else if (strcmp(arg, "--status") == 0) opt.status_path = value;
+    else {
+      fprintf(stderr, "unknown option %s\n", arg);
+      return 1;
+    }
+    if (end != NULL && (end == value || *end != '\0')) {
+      fprintf(stderr, "invalid number %s for %s\n", value, arg);
+      return 1;
+    }
+  }
+  if (opt.max <= 0) {
+    fprintf(stderr, "--max must be positive\n");
+    return 1;
+  }
+  if (text == NULL) {
+    fprintf(stderr, "usage: %s -f EXPR [--bounds LO,HI[,LO,HI]] "
+            "[--max N] [--optimum VALUE] [--status PATH]\n", argv[0]);
+    return 1;
+  }
+
+  char error[128];
+  if (!clogo_expr_parse(&expr_objective, text, error, sizeof(error))) {
+    fprintf(stderr, "%s: %s\n", text, error);
+    return 1;
+  }
+
+  //Either one pair of bounds for every input, or a pair 
+  //per input.
+  if (bounds != NULL) {
+    double b[2 * DIM];
+    int count = 0;
+    for (const char *c = bounds; count < 2 * DIM; c++) {
+      char *end;
+      b[count] = strtod(c, &end);
+      if (end == c) break;
+      count++;
+      c = end;
+      if (*c != ',') break;
+    }
+    if (count != 2 && count != 2 * DIM) {
+      fprintf(stderr, "invalid bounds %s\n", bounds);
+      clogo_expr_delete(&expr_objective);
+      return 1;
+    }
+    for (int d = 0; d < DIM; d++) {
+      expr_objective.lo[d] = count == 2 ? b[0] : b[2 * d];
+      expr_objective.hi[d] = count == 2 ? b[1] : b[2 * d + 1];
+    }
+  }
+
+  //Hand the children of every expansion to the interpreter
+  //together.
+  opt.fn = &fn_expr;
+  opt.fn_batch = &fn_expr_batch;
+  opt.batch = 1;
+  struct clogo_result r = clogo_optimize(&opt);
+
+  double point[DIM];
+  clogo_expr_map(&expr_objective, r.point, point);
+  printf("value: %.9g\t samples: %" PRId64 "\t point:", r.value, r.samples);
+  for (int d = 0; d < DIM; d++) printf(" %.9g", point[d]);
+  printf("\n");
+
+  clogo_expr_delete(&expr_objective);
+  return 0;
+} /* run_expr() */
+
 /***********************************************************
 * main
+*
+* Runs the SOO demo step by step, or optimizes the 
+* objective given on the command line. The demos of the 
+* other features are in clbench --demos.
 ***********************************************************/
-int main() 
+int main(
+  int argc,
+  char **argv
+) 
 {
+  //Objectives given on the command line replace the demo.
+  if (argc > 1) return run_expr(argc, argv);
+
   struct clogo_options opt = test_soo();
   struct clogo_state state = clogo_init(&opt);
   while (!clogo_done(&state)) {
@@ -0,0 +1,96 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/noise.h"
+#include "clogo/clogo_private.h"
+#include "clogo/fidelity.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* noise_bonus
+*
+* Returns the width of the confidence interval of a mean of
+* `evals` evaluations, as used by StoSOO: 
+*   range * sqrt(log(max * noise_k / delta) / (2 * evals))
+***********************************************************/
+static double noise_bonus(
+  const struct clogo_state *state,
+                           //current optimization state
+  int64_t evals            //number of evaluations
+)
+{
+  const struct clogo_options *opt = state->opt;
+  if (opt->noise_k <= 0 || evals <= 0) return 0.0;
+
+  double delta = opt->noise_delta > 0.0 ? opt->noise_delta : NOISE_DEFAULT_DELTA;
+  double range = opt->noise_range > 0.0 ? opt->noise_range : 1.0;
+  double trials = (double)opt->max * opt->noise_k;
+  return range * sqrt(log(trials / delta) / (2.0 * evals));
+} /* noise_bonus() */
+
+/***********************************************************
+* noise_set
+*
+* Sets the statistics of a node from the mean of `evals` 
+* evaluations at its center. In noisy mode, the node's value
+* becomes the upper confidence bound of the mean (in the 
+* style of StoSOO); otherwise it's the mean itself.
+***********************************************************/
+void noise_set(
+  struct node *n,          //node to modify
+  double mean,             //mean of the evaluations
+  int64_t evals,           //number of evaluations
+  const struct clogo_state *state
+                           //current optimization state
+)
+{
+  n->mean = mean;
+  n->evals = evals;
+  n->value = mean + noise_bonus(state, evals);
+} /* noise_set() */
+
+/***********************************************************
+* noise_refine
+*
+* In noisy mode, evaluates a node that has been evaluated
+* fewer than `noise_k` times as many more times as needed,
+* as a single batch, and returns true. Returns false if the
+* node doesn't need any more evaluations.
+***********************************************************/
+bool noise_refine(
+  struct node *n,          //node to refine
+  struct clogo_state *state//current optimization state
+)
+{
+  const struct clogo_options *opt = state->opt;
+  if (n->evals >= opt->noise_k) return false;
+
+  //Never go over budget for the sake of a tighter bound.
+  int64_t count = opt->noise_k - n->evals;
+  int64_t left = (int64_t)ceil((double)opt->max - state->cost);
+  if (count > left) count = left;
+  if (count <= 0) return false;
+
+  double center[DIM];
+  calculate_center(n, center);
+  double *values = malloc(sizeof(*values) * count);
+  fidelity_evaluate_repeated(state, n->fidelity, center, (int)count, values);
+
+  double sum = n->mean * n->evals;
+  for (int64_t i = 0; i < count; i++) sum += values[i];
+  free(values);
+
+  noise_set(n, sum / (n->evals + count), n->evals + count, state);
+  if (n->evals >= opt->noise_k && n->mean > state->noise_best_value) {
+    state->noise_best_value = n->mean;
+    for (int i = 0; i < DIM; i++) state->noise_best_point[i] = center[i];
+  }
+  return true;
+} /* noise_refine() */
@@ -0,0 +1,141 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#define _DEFAULT_SOURCE
+#include "clogo/portfolio.h"
+#include "clogo/clogo_private.h"
+#include "clogo/table.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* portfolio_member
+*
+* Everything a member thread needs to run.
+***********************************************************/
+struct portfolio_member {
+  struct clogo_options opt;//options, pointing at the table
+  struct clogo_result result;
+                           //result of the member
+  pthread_barrier_t *start;//barrier every member waits at,
+                           //so none finishes before the 
+                           //others have started
+  int *finished;           //shared count of finished members
+  pthread_mutex_t *lock;   //lock protecting `finished`
+  int order;               //0-based finishing position
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* portfolio_run
+*
+* Thread entry point for a single member. The member 
+* yields after every step, so that members keep pace with
+* each other even when there are fewer cores than members.
+* A member that stopped because another one reached the 
+* optimum reports the best point of the shared table as 
+* its result.
+***********************************************************/
+static void * portfolio_run(
+  void *arg                //portfolio_member to run
+)
+{
+  struct portfolio_member *m = arg;
+  pthread_barrier_wait(m->start);
+  struct clogo_state state = clogo_init(&m->opt);
+  while (!clogo_done(&state)) {
+    clogo_step(&state);
+    sched_yield();
+  }
+  m->result = clogo_finish(&state);
+  clogo_delete(&state);
+
+  double point[DIM];
+  double shared = table_best(m->opt.table, point);
+  if (shared > m->result.value && val_error(&m->opt, shared) < m->opt.epsilon) {
+    m->result.value = shared;
+    memcpy(m->result.point, point, sizeof(point));
+  }
+
+  pthread_mutex_lock(m->lock);
+  m->order = (*m->finished)++;
+  pthread_mutex_unlock(m->lock);
+  return NULL;
+} /* portfolio_run() */
+
+/***********************************************************
+* clogo_portfolio
+*
+* Runs several optimizations of the same objective at the
+* same time, one thread each. The members share a table of
+* evaluations so no point is evaluated twice, and the best 
+* value found by any member feeds every member's 
+* termination check. The members all start together, and
+* one that stops on another's optimum returns that point.
+* The objective must be thread safe. `results` receives 
+* one result per member.
+***********************************************************/
+struct clogo_portfolio_result clogo_portfolio(
+  const struct clogo_options *members,
+                           //options of each member
+  int count,               //number of members
+  struct clogo_result *results
+                           //output result of each member
+)
+{
+  struct clogo_table table;
+  clogo_table_init(&table, PORTFOLIO_TABLE_BUCKETS, true);
+  pthread_mutex_t lock;
+  pthread_mutex_init(&lock, NULL);
+  pthread_barrier_t start;
+  pthread_barrier_init(&start, NULL, count);
+  int finished = 0;
+
+  //Start every member on its own thread...
+  struct portfolio_member *m = malloc(sizeof(*m) * count);
+  pthread_t *threads = malloc(sizeof(*threads) * count);
+  for (int i = 0; i < count; i++) {
+    m[i].opt = members[i];
+    m[i].opt.table = &table;
+    m[i].start = &start;
+    m[i].finished = &finished;
+    m[i].lock = &lock;
+    int err = pthread_create(&threads[i], NULL, portfolio_run, &m[i]);
+    assert(err == 0);
+    (void)err;
+  }
+
+  //...and collect them once they're done.
+  struct clogo_portfolio_result summary = {
+    .first = -1,
+    .unique = 0,
+    .samples = 0
+  };
+  for (int i = 0; i < count; i++) {
+    pthread_join(threads[i], NULL);
+    results[i] = m[i].result;
+    summary.samples += m[i].result.samples;
+    if (m[i].order == 0) summary.first = i;
+  }
+  summary.unique = table.unique;
+
+  free(threads);
+  free(m);
+  pthread_barrier_destroy(&start);
+  pthread_mutex_destroy(&lock);
+  clogo_table_delete(&table);
+  return summary;
+} /* clogo_portfolio() */
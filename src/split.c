@@ -0,0 +1,101 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/split.h"
+#include "clogo/grid.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* split_dim
+*
+* Returns the dimension a cell should be split along, or -1
+* if it shouldn't be split at all.
+***********************************************************/
+int split_dim(
+  const struct clogo_state *state,
+  const struct node *n
+)
+{
+  const struct clogo_options *opt = state->opt;
+  int widest = grid_split_dim(opt, n);
+  if (!opt->adaptive_split || widest < 0) return widest;
+
+  //Same tie-break as grid_split_dim: cycle with depth.
+  int best = -1;
+  double best_gain = -1.0;
+  for (int j = 0; j < DIM; j++) {
+    int d = (n->depth + j) % DIM;
+    if (opt->resolution != NULL && n->sizes[d] <= opt->resolution[d]) continue;
+    if (n->sizes[d] * SPLIT_ASPECT < n->sizes[widest]) continue;
+
+    double gain = (
+      n->sensitivity[d] >= 0.0 ? n->sensitivity[d] * n->sizes[d] : INFINITY
+    );
+    if (gain > best_gain) {
+      best = d;
+      best_gain = gain;
+    }
+  }
+  return best;
+} /* split_dim() */
+
+/***********************************************************
+* split_observe
+*
+* Sets the sensitivity of a freshly sampled child along the
+* dimension its parent was split along.
+***********************************************************/
+void split_observe(
+  double anchor_value,
+  double dist,
+  int anchor_fidelity,
+  struct node *n,
+  struct clogo_state *state
+)
+{
+  //Same conditions as the surrogate's slopes.
+  if (!state->opt->adaptive_split || n->split < 0) return;
+  if (n->estimated || n->fidelity != anchor_fidelity) return;
+  if (dist <= 0.0 || !isfinite(anchor_value)) return;
+
+  //The child's center only moved along the split dimension.
+  n->sensitivity[n->split] = fabs(n->mean - anchor_value) / dist;
+} /* split_observe() */
+
+
+/***********************************************************
+* split_share
+*
+* Gives every child of an expansion the steepest slope its
+* sampled siblings observed along the split dimension.
+***********************************************************/
+void split_share(
+  struct node **children,
+  int count,
+  const struct clogo_state *state
+)
+{
+  if (!state->opt->adaptive_split) return;
+
+  //Only children split_observe saw have a fresh slope; the
+  //middle one holds its parent's sample.
+  int d = children[0]->split;
+  double steepest = -1.0;
+  for (int i = 0; i < count; i++) {
+    const struct node *c = children[i];
+    if (i == count / 2 || c->pending || c->estimated || c->infeasible) continue;
+    if (c->sensitivity[d] > steepest) steepest = c->sensitivity[d];
+  }
+  if (steepest < 0.0) return;
+
+  for (int i = 0; i < count; i++) {
+    if (!children[i]->pending) children[i]->sensitivity[d] = steepest;
+  }
+} /* split_share() */
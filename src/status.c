@@ -0,0 +1,210 @@
+//ftruncate() isn't part of strict C11
+#define _DEFAULT_SOURCE
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/status.h"
+#include "clogo/clogo_private.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* status_open
+*
+* Creates (or truncates) the file at the `status_path` of
+* the options and maps it as the state's status page. If 
+* that fails, the error is reported and the optimization
+* carries on without one.
+***********************************************************/
+void status_open(
+  struct clogo_state *state
+)
+{
+  state->status = NULL;
+  const char *path = state->opt->status_path;
+  if (path == NULL) return;
+
+  struct clogo_status_page *page = MAP_FAILED;
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd != -1 && ftruncate(fd, sizeof(*page)) == 0) {
+    page = mmap(NULL, sizeof(*page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (page == MAP_FAILED) {
+    fprintf(stderr, "status: can't publish to %s: %s\n", path, strerror(errno));
+    if (fd != -1) close(fd);
+    return;
+  }
+  close(fd);
+
+  //The file starts out zeroed, so readers see no magic 
+  //until the first snapshot is complete.
+  page->dim = DIM;
+  atomic_init(&page->sequence, 0);
+  state->status = page;
+  status_publish(state);
+  page->magic = STATUS_MAGIC;
+} /* status_open() */
+
+/***********************************************************
+* status_write
+*
+* Writes the given snapshot to a status page under its 
+* seqlock.
+***********************************************************/
+static void status_write(
+  struct clogo_status_page *page,
+                           //page to write
+  const struct clogo_status *status
+                           //snapshot to publish
+)
+{
+  uint64_t sequence = atomic_load_explicit(&page->sequence, memory_order_relaxed);
+  atomic_store_explicit(&page->sequence, sequence + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  page->status = *status;
+  atomic_store_explicit(&page->sequence, sequence + 2, memory_order_release);
+} /* status_write() */
+
+/***********************************************************
+* status_snapshot
+*
+* Fills out a snapshot of the given state.
+***********************************************************/
+static void status_snapshot(
+  const struct clogo_state *state,
+  struct clogo_status *out //output snapshot
+)
+{
+  const struct space *s = &state->space;
+  struct clogo_result r = make_result(state);
+
+  out->steps = s->clock;
+  out->samples = state->samples;
+  out->cost = state->cost;
+  out->w = state->w;
+  out->best_value = r.value;
+  for (int i = 0; i < DIM; i++) out->best_point[i] = r.point[i];
+
+  out->depth_count = s->capacity < STATUS_DEPTHS ? s->capacity : STATUS_DEPTHS;
+  for (int h = 0; h < out->depth_count; h++) out->depths[h] = 0;
+  for (int h = 0; h < s->capacity; h++) {
+    int slot = h < STATUS_DEPTHS ? h : STATUS_DEPTHS - 1;
+    out->depths[slot] += s->depth[h].count;
+  }
+  out->final = s->final.count;
+  out->done = false;
+} /* status_snapshot() */
+
+/***********************************************************
+* status_publish
+*
+* Publishes a snapshot of the state to its status page, if
+* it has one.
+***********************************************************/
+void status_publish(
+  struct clogo_state *state
+)
+{
+  if (state->status == NULL) return;
+
+  struct clogo_status status;
+  status_snapshot(state, &status);
+  status.done = term_cond_met(state, NULL);
+  status_write(state->status, &status);
+} /* status_publish() */
+
+/***********************************************************
+* status_close
+*
+* Publishes a last snapshot marked as done and unmaps the
+* status page.
+***********************************************************/
+void status_close(
+  struct clogo_state *state
+)
+{
+  if (state->status == NULL) return;
+
+  struct clogo_status status;
+  status_snapshot(state, &status);
+  status.done = true;
+  status_write(state->status, &status);
+  munmap(state->status, sizeof(*state->status));
+  state->status = NULL;
+} /* status_close() */
+
+/***********************************************************
+* clogo_status_map
+*
+* Maps the status page published at the given path for
+* reading. Returns NULL if it can't be.
+***********************************************************/
+const struct clogo_status_page * clogo_status_map(
+  const char *path
+)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd == -1) return NULL;
+  if (lseek(fd, 0, SEEK_END) < (off_t)sizeof(struct clogo_status_page)) {
+    close(fd);
+    return NULL;
+  }
+  const struct clogo_status_page *page = mmap(
+    NULL, sizeof(*page), PROT_READ, MAP_SHARED, fd, 0
+  );
+  close(fd);
+  if (page == MAP_FAILED) return NULL;
+
+  if (page->magic != STATUS_MAGIC || page->dim != DIM) {
+    clogo_status_unmap(page);
+    return NULL;
+  }
+  return page;
+} /* clogo_status_map() */
+
+/***********************************************************
+* clogo_status_unmap
+*
+* Unmaps a page mapped by clogo_status_map.
+***********************************************************/
+void clogo_status_unmap(
+  const struct clogo_status_page *page
+)
+{
+  munmap((void *)page, sizeof(*page));
+} /* clogo_status_unmap() */
+
+/***********************************************************
+* clogo_status_read
+*
+* Copies a consistent snapshot out of a status page, 
+* retrying while the writer is in the middle of an update.
+***********************************************************/
+void clogo_status_read(
+  const struct clogo_status_page *page,
+  struct clogo_status *out
+)
+{
+  //The page is only mapped for reading, so the sequence 
+  //is only ever loaded.
+  _Atomic uint64_t *sequence = (_Atomic uint64_t *)&page->sequence;
+  for (;;) {
+    uint64_t before = atomic_load_explicit(sequence, memory_order_acquire);
+    if (before & 1) continue;
+    *out = page->status;
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(sequence, memory_order_relaxed) == before) return;
+  }
+} /* clogo_status_read() */
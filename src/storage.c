@@ -0,0 +1,245 @@
+//mkstemp() and madvise() aren't part of strict C11
+#define _DEFAULT_SOURCE
+
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/storage.h"
+#include "clogo/clogo_private.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* storage_map
+*
+* Returns `bytes` of memory backed by a new anonymous file 
+* in the directory of the pool. The file is unlinked right
+* away, so it disappears as soon as it's unmapped. Returns
+* NULL, after reporting why and giving up on files for the
+* pool, if the file can't be created or mapped.
+***********************************************************/
+static void * storage_map(
+  struct node_pool *p,     //pool the memory belongs with
+  size_t bytes             //size of the mapping
+)
+{
+  char name[4096];
+  int len = snprintf(name, sizeof(name), "%s/clogo-XXXXXX", p->path);
+  void *mapped = MAP_FAILED;
+  int fd = -1;
+  errno = ENAMETOOLONG;
+  if (len > 0 && len < (int)sizeof(name)) fd = mkstemp(name);
+  if (fd != -1) {
+    unlink(name);
+    if (ftruncate(fd, (off_t)bytes) == 0) {
+      mapped = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+  }
+  if (mapped == MAP_FAILED) {
+    fprintf(stderr, "storage: can't map a file in %s: %s\n", p->path, strerror(errno));
+    p->path = NULL;
+    p->failed = true;
+    mapped = NULL;
+  }
+  if (fd != -1) close(fd);
+  return mapped;
+} /* storage_map() */
+
+/***********************************************************
+* storage_alloc
+*
+* Allocates an uninitialized node for the given depth level
+* from that level's pool, growing the space as needed. 
+* Levels at or below `storage_depth` are backed by memory-
+* mapped files in `storage_path`, if one is set, so they 
+* are bounded by disk rather than by RAM.
+***********************************************************/
+struct node * storage_alloc(
+  struct clogo_state *state,
+                           //state owning the space
+  int depth                //depth level of the new node
+)
+{
+  const struct clogo_options *opt = state->opt;
+  struct space *s = &state->space;
+  while (s->capacity <= depth) grow_space(s);
+  struct node_list *l = &s->depth[depth];
+  struct node_pool *p = &l->pool;
+  //One failure is reported, not one per level.
+  if (p->failed) s->unmapped = true;
+  p->path = NULL;
+  if (opt->storage_path != NULL && depth >= opt->storage_depth && !s->unmapped) {
+    p->path = opt->storage_path;
+  }
+
+  //Reuse nodes of expanded cells first.
+  if (p->free != NULL) {
+    struct node *n = p->free;
+    p->free = n->next;
+    return n;
+  }
+
+  struct storage_segment *seg = p->segments;
+  if (seg == NULL || seg->used == seg->capacity) {
+    //Segments double in size, so huge levels only need a 
+    //few of them but sparse ones waste little.
+    int64_t capacity = STORAGE_MIN_SEGMENT;
+    if (seg != NULL) capacity = seg->capacity * 2;
+    if (capacity > STORAGE_MAX_SEGMENT) capacity = STORAGE_MAX_SEGMENT;
+
+    seg = malloc(sizeof(*seg));
+    seg->capacity = capacity;
+    seg->used = 0;
+    size_t bytes = sizeof(*seg->nodes) * (size_t)capacity;
+    seg->nodes = p->path != NULL ? storage_map(p, bytes) : NULL;
+    seg->mapped = seg->nodes != NULL;
+    if (p->failed) s->unmapped = true;
+    if (!seg->mapped) seg->nodes = malloc(bytes);
+    seg->next = p->segments;
+    p->segments = seg;
+  }
+
+  return &seg->nodes[seg->used++];
+} /* storage_alloc() */
+
+/***********************************************************
+* storage_grow
+*
+* Grows the heap array of a list to `capacity` elements, in
+* the same kind of memory as the nodes of its pool.
+***********************************************************/
+void storage_grow(
+  struct node_list *l,     //list whose heap to grow
+  int64_t capacity         //new number of heap elements
+)
+{
+  size_t old_bytes = sizeof(*l->heap) * (size_t)l->capacity;
+  size_t bytes = sizeof(*l->heap) * (size_t)capacity;
+  struct node_pool *p = &l->pool;
+  l->capacity = capacity;
+  if (p->path == NULL && !l->mapped) {
+    l->heap = realloc(l->heap, bytes);
+    return;
+  }
+
+  struct node **grown = p->path != NULL ? storage_map(p, bytes) : NULL;
+  bool mapped = grown != NULL;
+  if (!mapped) grown = malloc(bytes);
+  if (l->heap != NULL) {
+    memcpy(grown, l->heap, old_bytes);
+    if (l->mapped) munmap(l->heap, old_bytes);
+    else free(l->heap);
+  }
+  l->heap = grown;
+  l->mapped = mapped;
+} /* storage_grow() */
+
+/***********************************************************
+* storage_free
+*
+* Gives a node that has been removed from the space back to
+* the pool of its depth level.
+***********************************************************/
+void storage_free(
+  struct clogo_state *state,
+                           //state owning the space
+  struct node *n           //node to free
+)
+{
+  struct node_pool *p = &state->space.depth[n->depth].pool;
+  n->next = p->free;
+  p->free = n;
+} /* storage_free() */
+
+/***********************************************************
+* storage_release
+*
+* Hands the pages of a file-backed mapping back to the OS.
+***********************************************************/
+static void storage_release(
+  void *p,                 //start of the mapping
+  size_t bytes             //size of the mapping
+)
+{
+  //Dirty pages have to reach the file first, since the
+  //mapping is about to forget them.
+  msync(p, bytes, MS_SYNC);
+  madvise(p, bytes, MADV_DONTNEED);
+} /* storage_release() */
+
+/***********************************************************
+* storage_release_cold
+*
+* Hands the file-backed memory of depth levels that haven't
+* changed for STORAGE_COLD_STEPS steps back to the OS.
+* The nodes stay valid and are read back from their files
+* when touched again.
+***********************************************************/
+void storage_release_cold(
+  struct clogo_state *state//state owning the space
+)
+{
+  struct space *s = &state->space;
+  if (state->opt->storage_path == NULL) return;
+
+  for (int h = state->opt->storage_depth; h < s->capacity; h++) {
+    struct node_list *l = &s->depth[h];
+    if (l->pool.path == NULL || l->released) continue;
+    if (s->clock - l->touched < STORAGE_COLD_STEPS) continue;
+
+    for (struct storage_segment *seg = l->pool.segments; seg; seg = seg->next) {
+      if (!seg->mapped) continue;
+      storage_release(seg->nodes, sizeof(*seg->nodes) * (size_t)seg->capacity);
+    }
+    if (l->mapped) {
+      storage_release(l->heap, sizeof(*l->heap) * (size_t)l->capacity);
+    }
+    l->released = true;
+  }
+} /* storage_release_cold() */
+
+/***********************************************************
+* storage_delete_list
+*
+* Frees a list's heap array and every segment of its pool,
+* along with all the nodes allocated from it.
+***********************************************************/
+void storage_delete_list(
+  struct node_list *l      //list to delete
+)
+{
+  struct node_pool *p = &l->pool;
+  if (l->mapped) {
+    munmap(l->heap, sizeof(*l->heap) * (size_t)l->capacity);
+  } else {
+    free(l->heap);
+  }
+  l->heap = NULL;
+  l->mapped = false;
+  l->count = 0;
+  l->capacity = 0;
+
+  struct storage_segment *seg = p->segments;
+  while (seg != NULL) {
+    struct storage_segment *next = seg->next;
+    if (seg->mapped) {
+      munmap(seg->nodes, sizeof(*seg->nodes) * (size_t)seg->capacity);
+    } else {
+      free(seg->nodes);
+    }
+    free(seg);
+    seg = next;
+  }
+  p->segments = NULL;
+  p->free = NULL;
+} /* storage_delete_list() */
@@ -0,0 +1,119 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/surrogate.h"
+#include "clogo/clogo_private.h"
+
+#include <math.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* surrogate_estimate
+*
+* Decides whether a node can skip its sample (in the style
+* of BaMSOO). The node's value is bounded by a local 
+* Lipschitz model anchored at the nearest real sample of 
+* its ancestry. If the upper bound can't beat the best 
+* value observed so far, the node is filled with the lower
+* bound, flagged as estimated, and true is returned. 
+* Otherwise nothing is modified and false is returned, 
+* meaning the node must really be sampled.
+***********************************************************/
+bool surrogate_estimate(
+  struct node *n,          //node to consider
+  double anchor_value,     //value of the anchoring sample
+  double dist,             //distance from the center of `n`
+                           //to the anchoring sample
+  struct clogo_state *state//current optimization state
+)
+{
+  //Convenience alias for the optimization options.
+  const struct clogo_options *opt = state->opt;
+
+  //Surrogate disabled, or not enough information to trust
+  //the model yet-- always sample.
+  if (opt->surrogate <= 0.0) return false;
+  if (state->slopes < SURROGATE_MIN_SLOPES) return false;
+
+  double slope = opt->surrogate * state->lipschitz;
+  double upper = anchor_value + slope * dist;
+
+  //If the child could still turn out to be the best node,
+  //we have to find out for real.
+  if (upper > state->last_best_value) return false;
+
+  //Otherwise, use the pessimistic bound so that the node
+  //never looks better than it could actually be.
+  n->value = anchor_value - slope * dist;
+  n->mean = n->value;
+  n->evals = 0;
+  n->anchor_value = anchor_value;
+  n->anchor_dist = dist;
+  n->estimated = true;
+  state->estimates++;
+
+  return true;
+} /* surrogate_estimate() */
+
+/***********************************************************
+* surrogate_observe
+*
+* Updates the Lipschitz estimate of the state using a 
+* freshly sampled node and the sample it was anchored at.
+* Nodes that are only estimated, or that were sampled at a
+* different fidelity than the anchor, are ignored.
+***********************************************************/
+void surrogate_observe(
+  double anchor_value,     //value of the anchoring sample
+  double dist,             //distance from the center of `n`
+                           //to the anchoring sample
+  int anchor_fidelity,     //fidelity of the anchoring sample
+  const struct node *n,    //freshly sampled node
+  struct clogo_state *state//state to update
+)
+{
+  if (n->estimated || n->fidelity != anchor_fidelity) return;
+  if (dist <= 0.0) return;
+  //Infeasible cells have no real sample to anchor a slope.
+  if (!isfinite(anchor_value)) return;
+
+  //Only the most recent slopes are kept, so the estimate 
+  //follows the region (and scale) the search is currently 
+  //working on rather than the steepest slope ever seen.
+  double slope = fabs(n->mean - anchor_value) / dist;
+  state->window[state->slopes % SURROGATE_WINDOW] = slope;
+  state->slopes++;
+
+  int count = state->slopes < SURROGATE_WINDOW ? state->slopes : SURROGATE_WINDOW;
+  state->lipschitz = 0.0;
+  for (int i = 0; i < count; i++) {
+    if (state->window[i] > state->lipschitz) state->lipschitz = state->window[i];
+  }
+} /* surrogate_observe() */
+
+/***********************************************************
+* center_distance
+*
+* Returns the euclidean distance between the centers of two
+* nodes.
+***********************************************************/
+double center_distance(
+  const struct node *a,    //first node
+  const struct node *b     //second node
+)
+{
+  double ca[DIM], cb[DIM];
+  calculate_center(a, ca);
+  calculate_center(b, cb);
+
+  double sum = 0.0;
+  for (int i = 0; i < DIM; i++) {
+    double d = ca[i] - cb[i];
+    sum += d * d;
+  }
+  return sqrt(sum);
+} /* center_distance() */
@@ -0,0 +1,356 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/table.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* table_hash
+*
+* Hashes `size` bytes (FNV-1a).
+***********************************************************/
+uint64_t table_hash(
+  const void *data,        //bytes to hash
+  size_t size              //number of bytes
+)
+{
+  uint64_t h = 14695981039346656037ULL;
+  const unsigned char *bytes = data;
+  for (size_t i = 0; i < size; i++) {
+    h = (h ^ bytes[i]) * 1099511628211ULL;
+  }
+  return h;
+} /* table_hash() */
+
+/***********************************************************
+* entry_hash
+*
+* Hashes the bits of a point and fidelity level.
+***********************************************************/
+static uint64_t entry_hash(
+  int level,               //fidelity level
+  const double *point      //point to hash
+)
+{
+  uint64_t h = table_hash(point, sizeof(*point) * DIM);
+  return (h ^ (uint64_t)level) * 1099511628211ULL;
+} /* entry_hash() */
+
+/***********************************************************
+* table_find
+*
+* Returns the entry for a point in the given bucket, or 
+* NULL. The bucket's lock must be held.
+***********************************************************/
+static struct table_entry * table_find(
+  struct table_entry *e,   //first entry of the bucket
+  int level,               //fidelity level
+  const double *point      //point to look for
+)
+{
+  for (; e != NULL; e = e->next) {
+    if (e->level == level && memcmp(e->point, point, sizeof(e->point)) == 0) {
+      return e;
+    }
+  }
+  return NULL;
+} /* table_find() */
+
+/***********************************************************
+* table_lock
+*
+* Locks the stripe of a hash, if the table is shared, and
+* returns the stripe.
+***********************************************************/
+static int table_lock(
+  struct clogo_table *t,   //table to lock
+  uint64_t h               //hash of the point
+)
+{
+  int stripe = (int)(h & (TABLE_STRIPES - 1));
+  if (t->shared) pthread_mutex_lock(&t->locks[stripe]);
+  return stripe;
+} /* table_lock() */
+
+/***********************************************************
+* table_unlock
+*
+* Unlocks a stripe locked by table_lock.
+***********************************************************/
+static void table_unlock(
+  struct clogo_table *t,   //table to unlock
+  int stripe               //stripe returned by table_lock
+)
+{
+  if (t->shared) pthread_mutex_unlock(&t->locks[stripe]);
+} /* table_unlock() */
+
+/***********************************************************
+* table_bucket
+*
+* Returns the bucket of a hash. The stripe of the hash must
+* be locked, since the table may be growing.
+***********************************************************/
+static struct table_entry ** table_bucket(
+  struct clogo_table *t,   //table to search
+  uint64_t h               //hash of the point
+)
+{
+  return &t->buckets[h & (uint64_t)(t->bucket_count - 1)];
+} /* table_bucket() */
+
+/***********************************************************
+* table_grow
+*
+* Doubles the buckets of a table if it's too full. Every 
+* stripe is locked, in order, while the entries are moved;
+* the caller must hold none of them.
+***********************************************************/
+static void table_grow(
+  struct clogo_table *t    //table to grow
+)
+{
+  if (t->shared) {
+    for (int i = 0; i < TABLE_STRIPES; i++) pthread_mutex_lock(&t->locks[i]);
+  }
+
+  //Another thread may have grown it in the meantime.
+  int64_t entries = atomic_load_explicit(&t->entries, memory_order_relaxed);
+  if (entries > t->bucket_count * TABLE_LOAD) {
+    int64_t count = t->bucket_count * 2;
+    struct table_entry **buckets = calloc(count, sizeof(*buckets));
+    for (int64_t b = 0; b < t->bucket_count; b++) {
+      struct table_entry *e = t->buckets[b];
+      while (e != NULL) {
+        struct table_entry *next = e->next;
+        uint64_t h = entry_hash(e->level, e->point) & (uint64_t)(count - 1);
+        e->next = buckets[h];
+        buckets[h] = e;
+        e = next;
+      }
+    }
+    free(t->buckets);
+    t->buckets = buckets;
+    t->bucket_count = count;
+  }
+
+  if (t->shared) {
+    for (int i = TABLE_STRIPES - 1; i >= 0; i--) pthread_mutex_unlock(&t->locks[i]);
+  }
+} /* table_grow() */
+
+/***********************************************************
+* clogo_table_init
+*
+* Initialize an empty table with room for about 
+* `bucket_count` entries before it first grows.
+***********************************************************/
+void clogo_table_init(
+  struct clogo_table *t,   //table to initialize
+  int64_t bucket_count,    //initial number of buckets
+  bool shared              //true if threads share the table
+)
+{
+  //Round up to a power of two no smaller than the number 
+  //of stripes.
+  t->bucket_count = TABLE_STRIPES;
+  while (t->bucket_count < bucket_count) t->bucket_count *= 2;
+  t->buckets = calloc(t->bucket_count, sizeof(*t->buckets));
+  t->shared = shared;
+  atomic_init(&t->entries, 0);
+  if (shared) {
+    for (int i = 0; i < TABLE_STRIPES; i++) {
+      pthread_mutex_init(&t->locks[i], NULL);
+      pthread_cond_init(&t->filled[i], NULL);
+    }
+    pthread_mutex_init(&t->best_lock, NULL);
+  }
+  t->best = -INFINITY;
+  memset(t->best_point, 0, sizeof(t->best_point));
+  t->unique = 0;
+} /* clogo_table_init() */
+
+/***********************************************************
+* clogo_table_delete
+*
+* Frees every entry of a table. No thread may be using it.
+***********************************************************/
+void clogo_table_delete(
+  struct clogo_table *t    //table to delete
+)
+{
+  for (int64_t b = 0; b < t->bucket_count; b++) {
+    struct table_entry *e = t->buckets[b];
+    while (e != NULL) {
+      struct table_entry *next = e->next;
+      free(e);
+      e = next;
+    }
+  }
+  free(t->buckets);
+
+  if (t->shared) {
+    for (int i = 0; i < TABLE_STRIPES; i++) {
+      pthread_mutex_destroy(&t->locks[i]);
+      pthread_cond_destroy(&t->filled[i]);
+    }
+    pthread_mutex_destroy(&t->best_lock);
+  }
+} /* clogo_table_delete() */
+
+/***********************************************************
+* table_claim
+*
+* Looks up a point without ever blocking, claiming it if 
+* nobody has seen it yet.
+***********************************************************/
+enum table_status table_claim(
+  struct clogo_table *t,   //table to search
+  int level,               //fidelity level to sample at
+  const double *point,     //point to look up
+  double *value            //output value, if found
+)
+{
+  uint64_t h = entry_hash(level, point);
+  int stripe = table_lock(t, h);
+  struct table_entry **bucket = table_bucket(t, h);
+  struct table_entry *e = table_find(*bucket, level, point);
+
+  //Nobody has seen this point yet-- claim it.
+  if (e == NULL) {
+    e = malloc(sizeof(*e));
+    memcpy(e->point, point, sizeof(e->point));
+    e->level = level;
+    e->ready = false;
+    e->next = *bucket;
+    *bucket = e;
+    int64_t limit = t->bucket_count * TABLE_LOAD;
+    table_unlock(t, stripe);
+
+    //Keep chains short as the table fills up.
+    int64_t entries = atomic_fetch_add_explicit(&t->entries, 1, memory_order_relaxed);
+    if (entries + 1 > limit) table_grow(t);
+    return TABLE_CLAIMED;
+  }
+
+  //Someone else is evaluating it right now. Waiting here 
+  //could deadlock, so leave it to the caller.
+  if (!e->ready) {
+    table_unlock(t, stripe);
+    return TABLE_BUSY;
+  }
+  *value = e->value;
+  table_unlock(t, stripe);
+  return TABLE_FOUND;
+} /* table_claim() */
+
+/***********************************************************
+* table_lookup
+*
+* Looks up a point without claiming it.
+***********************************************************/
+bool table_lookup(
+  struct clogo_table *t,   //table to search
+  int level,               //fidelity level
+  const double *point,     //point to look up
+  double *value            //output value, if found
+)
+{
+  uint64_t h = entry_hash(level, point);
+  int stripe = table_lock(t, h);
+  struct table_entry *e = table_find(*table_bucket(t, h), level, point);
+  bool found = e != NULL && e->ready;
+  if (found) *value = e->value;
+  table_unlock(t, stripe);
+  return found;
+} /* table_lookup() */
+
+/***********************************************************
+* table_wait
+*
+* Waits for another thread to fill a point table_claim
+* reported as TABLE_BUSY, and returns its value.
+***********************************************************/
+double table_wait(
+  struct clogo_table *t,   //table to search
+  int level,               //fidelity level sampled at
+  const double *point      //point being evaluated
+)
+{
+  assert(t->shared);
+  uint64_t h = entry_hash(level, point);
+  int stripe = table_lock(t, h);
+  struct table_entry *e = table_find(*table_bucket(t, h), level, point);
+  assert(e != NULL);
+
+  //Entries keep their stripe when the table grows, so the
+  //filling thread signals this stripe's condition.
+  while (!e->ready) {
+    pthread_cond_wait(&t->filled[stripe], &t->locks[stripe]);
+  }
+  double value = e->value;
+  table_unlock(t, stripe);
+  return value;
+} /* table_wait() */
+
+/***********************************************************
+* table_fill
+*
+* Stores the value of a point previously claimed with 
+* table_claim and wakes up anyone waiting for it.
+***********************************************************/
+void table_fill(
+  struct clogo_table *t,   //table to modify
+  int level,               //fidelity level sampled at
+  const double *point,     //point that was evaluated
+  double value,            //value of the objective
+  bool full                //true if `level` is the real
+                           //objective
+)
+{
+  uint64_t h = entry_hash(level, point);
+  int stripe = table_lock(t, h);
+  struct table_entry *e = table_find(*table_bucket(t, h), level, point);
+  bool fresh = !e->ready;
+  e->value = value;
+  e->ready = true;
+  if (t->shared) pthread_cond_broadcast(&t->filled[stripe]);
+  table_unlock(t, stripe);
+
+  if (t->shared) pthread_mutex_lock(&t->best_lock);
+  if (fresh) t->unique++;
+  if (full && value > t->best) {
+    t->best = value;
+    memcpy(t->best_point, point, sizeof(t->best_point));
+  }
+  if (t->shared) pthread_mutex_unlock(&t->best_lock);
+} /* table_fill() */
+
+/***********************************************************
+* table_best
+*
+* Returns the best full fidelity value in the table, and 
+* stores its point in `point` unless that is NULL.
+***********************************************************/
+double table_best(
+  struct clogo_table *t,   //table to examine
+  double *point            //output point of the best value,
+                           //or NULL
+)
+{
+  if (t->shared) pthread_mutex_lock(&t->best_lock);
+  double best = t->best;
+  if (point != NULL) memcpy(point, t->best_point, sizeof(t->best_point));
+  if (t->shared) pthread_mutex_unlock(&t->best_lock);
+  return best;
+} /* table_best() */
@@ -0,0 +1,96 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/testfn.h"
+
+#include <math.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* rosenbrock_2
+*
+* 2D rosenbrock function - maps [0,1] to [-5,10].
+***********************************************************/
+double rosenbrock_2(
+  double *i
+) 
+{
+  double x = i[0], y = i[1];
+  double min = -5.0;
+  double max = 10.0;
+  x = min + x * (max - min);
+  y = min + y * (max - min);
+  return -(100.0 * pow(y - x * x, 2.0) + pow(x * x - 1.0, 2.0));
+} /* rosenbrock_2() */
+
+/***********************************************************
+* sin_helper
+*
+* Convenience function for calculating sin_X.
+***********************************************************/
+double sin_helper(
+  double x
+)
+{
+  return (sin(13.0 * x)*sin(27.0 * x) + 1.0) / 2;
+} /* sin_helper() */
+
+/***********************************************************
+* sin_2
+*
+* 2D sin test function.
+***********************************************************/
+double sin_2(
+  double *i
+)
+{
+  double x = i[0], y = i[1];
+  return sin_helper(x) * sin_helper(y);
+} /* sin_2() */
+
+/***********************************************************
+* rosenbrock_stretched_2
+*
+* rosenbrock_2 with the second input only spanning [0.5,
+* 1.5], so it matters much less than the first.
+***********************************************************/
+double rosenbrock_stretched_2(
+  double *i
+)
+{
+  double x = -5.0 + i[0] * 15.0;
+  double y = 0.5 + i[1];
+  return -(100.0 * pow(y - x * x, 2.0) + pow(x * x - 1.0, 2.0));
+} /* rosenbrock_stretched_2() */
+
+/***********************************************************
+* rosenbrock_rotated_2
+*
+* rosenbrock_stretched_2 with its inputs rotated by 30 
+* degrees around the center of the box.
+***********************************************************/
+double rosenbrock_rotated_2(
+  double *i
+)
+{
+  double c = sqrt(3.0) / 2.0, s = 0.5;
+  double x = i[0] - 0.5, y = i[1] - 0.5;
+  double rotated[2] = {0.5 + c * x - s * y, 0.5 + s * x + c * y};
+  return rosenbrock_stretched_2(rotated);
+} /* rosenbrock_rotated_2() */
+
+/***********************************************************
+* sin_stretched_2
+*
+* sin_2 with the second input only spanning [0.85, 0.9].
+***********************************************************/
+double sin_stretched_2(
+  double *i
+)
+{
+  return sin_helper(i[0]) * sin_helper(0.85 + 0.05 * i[1]);
+} /* sin_stretched_2() */
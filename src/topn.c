@@ -0,0 +1,368 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/topn.h"
+#include "clogo/clogo_private.h"
+#include "clogo/table.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+
+/*********************************************************************
+* TYPES
+*********************************************************************/
+
+/***********************************************************
+* topn_cursor
+*
+* A slot of a node list's heap whose node hasn't been 
+* visited yet. The slots below it in that heap are only
+* worth visiting once it has been.
+***********************************************************/
+struct topn_cursor {
+  const struct node_list *list;
+                           //list the slot belongs to
+  int64_t slot;            //slot in the list's heap
+};
+
+/***********************************************************
+* topn_frontier
+*
+* Binary max-heap of cursors, ordered by the value of the 
+* nodes they point at, so the best unvisited leaf of the
+* whole space is always first.
+***********************************************************/
+struct topn_frontier {
+  struct topn_cursor *heap;//cursors, best first
+  int64_t count;           //number of cursors in `heap`
+  int64_t capacity;        //number of elements in `heap`
+};
+
+/***********************************************************
+* topn_ready
+*
+* Binary max-heap of visited leaves, ordered by their mean.
+* A leaf's value is never below its mean, so once the best
+* of them has a mean no smaller than the value of the 
+* frontier's first cursor, no unvisited leaf can beat it.
+***********************************************************/
+struct topn_ready {
+  const struct node **heap;//visited leaves, best mean first
+  int64_t count;           //number of leaves in `heap`
+  int64_t capacity;        //number of elements in `heap`
+};
+
+/***********************************************************
+* topn_lattice
+*
+* Accepted points, hashed by the lattice cell of side 
+* `side` they fall in. Any point closer than `side` to a 
+* given one is in one of the neighbouring cells.
+***********************************************************/
+struct topn_lattice {
+  double side;             //width of a lattice cell
+  int *heads;              //first point of each bucket, -1
+                           //if empty
+  int *next;               //next point in the same bucket
+  int bucket_count;        //number of `heads` (power of 2)
+};
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* cursor_node
+*
+* Returns the node a cursor points at.
+***********************************************************/
+static const struct node * cursor_node(
+  const struct topn_cursor *c
+)
+{
+  return c->list->heap[c->slot];
+} /* cursor_node() */
+
+/***********************************************************
+* cursor_above
+*
+* Returns true if cursor `a` belongs above cursor `b` in
+* the frontier, using the same order as the node lists.
+***********************************************************/
+static bool cursor_above(
+  const struct topn_cursor *a,
+  const struct topn_cursor *b
+)
+{
+  return node_better(cursor_node(a), cursor_node(b));
+} /* cursor_above() */
+
+/***********************************************************
+* frontier_push
+*
+* Adds the given slot of a list to the frontier, if the
+* list has such a slot.
+***********************************************************/
+static void frontier_push(
+  struct topn_frontier *f, //frontier to modify
+  const struct node_list *l,
+                           //list the slot belongs to
+  int64_t slot             //slot in the list's heap
+)
+{
+  if (slot >= l->count) return;
+  if (f->count == f->capacity) {
+    f->capacity = f->capacity > 0 ? 2 * f->capacity : 64;
+    f->heap = realloc(f->heap, sizeof(*f->heap) * f->capacity);
+  }
+
+  struct topn_cursor c = {l, slot};
+  int64_t i = f->count++;
+  while (i > 0 && cursor_above(&c, &f->heap[(i - 1) / 2])) {
+    f->heap[i] = f->heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  f->heap[i] = c;
+} /* frontier_push() */
+
+/***********************************************************
+* frontier_pop
+*
+* Removes and returns the best cursor of the frontier, and
+* replaces it with the two slots below it in its list.
+***********************************************************/
+static struct topn_cursor frontier_pop(
+  struct topn_frontier *f  //frontier to modify (not empty)
+)
+{
+  struct topn_cursor top = f->heap[0];
+  struct topn_cursor last = f->heap[--f->count];
+  int64_t i = 0;
+  for (;;) {
+    int64_t c = 2 * i + 1;
+    if (c >= f->count) break;
+    if (c + 1 < f->count && cursor_above(&f->heap[c + 1], &f->heap[c])) c++;
+    if (!cursor_above(&f->heap[c], &last)) break;
+    f->heap[i] = f->heap[c];
+    i = c;
+  }
+  if (f->count > 0) f->heap[i] = last;
+
+  frontier_push(f, top.list, 2 * top.slot + 1);
+  frontier_push(f, top.list, 2 * top.slot + 2);
+  return top;
+} /* frontier_pop() */
+
+/***********************************************************
+* mean_above
+*
+* Returns true if leaf `a` belongs above leaf `b` in the 
+* ready heap: a higher mean first, then the node lists' 
+* order.
+***********************************************************/
+static bool mean_above(
+  const struct node *a,
+  const struct node *b
+)
+{
+  if (a->mean != b->mean) return a->mean > b->mean;
+  return node_better(a, b);
+} /* mean_above() */
+
+/***********************************************************
+* ready_push
+*
+* Adds a visited leaf to the ready heap.
+***********************************************************/
+static void ready_push(
+  struct topn_ready *r,    //heap to modify
+  const struct node *leaf  //leaf to add
+)
+{
+  if (r->count == r->capacity) {
+    r->capacity = r->capacity > 0 ? 2 * r->capacity : 64;
+    r->heap = realloc(r->heap, sizeof(*r->heap) * r->capacity);
+  }
+
+  int64_t i = r->count++;
+  while (i > 0 && mean_above(leaf, r->heap[(i - 1) / 2])) {
+    r->heap[i] = r->heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  r->heap[i] = leaf;
+} /* ready_push() */
+
+/***********************************************************
+* ready_pop
+*
+* Removes and returns the leaf of the ready heap with the 
+* best mean.
+***********************************************************/
+static const struct node * ready_pop(
+  struct topn_ready *r     //heap to modify (not empty)
+)
+{
+  const struct node *top = r->heap[0];
+  const struct node *last = r->heap[--r->count];
+  int64_t i = 0;
+  for (;;) {
+    int64_t c = 2 * i + 1;
+    if (c >= r->count) break;
+    if (c + 1 < r->count && mean_above(r->heap[c + 1], r->heap[c])) c++;
+    if (!mean_above(r->heap[c], last)) break;
+    r->heap[i] = r->heap[c];
+    i = c;
+  }
+  if (r->count > 0) r->heap[i] = last;
+  return top;
+} /* ready_pop() */
+
+/***********************************************************
+* lattice_bucket
+*
+* Returns the bucket of the lattice cell with the given 
+* coordinates.
+***********************************************************/
+static int lattice_bucket(
+  const struct topn_lattice *t,
+  const int64_t *cell      //coordinates of the cell (DIM)
+)
+{
+  uint64_t h = table_hash(cell, sizeof(*cell) * DIM);
+  return (int)(h & (uint64_t)(t->bucket_count - 1));
+} /* lattice_bucket() */
+
+/***********************************************************
+* lattice_cell
+*
+* Fills `cell` with the coordinates of the lattice cell the
+* given point falls in.
+***********************************************************/
+static void lattice_cell(
+  const struct topn_lattice *t,
+  const double *point,     //point to locate
+  int64_t *cell            //output coordinates (DIM)
+)
+{
+  for (int i = 0; i < DIM; i++) {
+    cell[i] = (int64_t)floor(point[i] / t->side);
+  }
+} /* lattice_cell() */
+
+/***********************************************************
+* lattice_clear
+*
+* Returns true if no accepted point is closer than the 
+* lattice's side to the given point. Only the 3^DIM cells 
+* around the point's own are looked at.
+***********************************************************/
+static bool lattice_clear(
+  const struct topn_lattice *t,
+  const struct clogo_optimum *accepted,
+                           //points accepted so far
+  const double *point      //point to check
+)
+{
+  int64_t home[DIM], cell[DIM];
+  lattice_cell(t, point, home);
+
+  int neighbours = 1;
+  for (int i = 0; i < DIM; i++) neighbours *= 3;
+  for (int o = 0; o < neighbours; o++) {
+    for (int i = 0, rest = o; i < DIM; i++, rest /= 3) {
+      cell[i] = home[i] + rest % 3 - 1;
+    }
+    for (int a = t->heads[lattice_bucket(t, cell)]; a >= 0; a = t->next[a]) {
+      double dist = 0.0;
+      for (int i = 0; i < DIM; i++) {
+        double d = accepted[a].point[i] - point[i];
+        dist += d * d;
+      }
+      if (dist < t->side * t->side) return false;
+    }
+  }
+  return true;
+} /* lattice_clear() */
+
+/***********************************************************
+* clogo_top_n
+*
+* Fills `out` with up to `n` of the sampled leaves of the 
+* space with the best means, best first, such that no two
+* are closer than `min_separation`. Returns the number of
+* leaves found.
+***********************************************************/
+int clogo_top_n(
+  const struct clogo_state *state,
+  int n,
+  double min_separation,
+  struct clogo_optimum *out
+)
+{
+  if (n <= 0) return 0;
+
+  const struct space *s = &state->space;
+  bool separate = min_separation > 0.0;
+  struct topn_lattice lattice = {.side = min_separation};
+  if (separate) {
+    lattice.bucket_count = 1;
+    while (lattice.bucket_count < 2 * n) lattice.bucket_count *= 2;
+    lattice.heads = malloc(sizeof(*lattice.heads) * lattice.bucket_count);
+    lattice.next = malloc(sizeof(*lattice.next) * n);
+    for (int b = 0; b < lattice.bucket_count; b++) lattice.heads[b] = -1;
+  }
+
+  //Every leaf is either in a depth list or in the final 
+  //list, and each of those is a heap: start from the top
+  //of each, and only go down a heap as it's used up.
+  struct topn_frontier frontier = {0};
+  for (int h = 0; h < s->capacity; h++) {
+    frontier_push(&frontier, &s->depth[h], 0);
+  }
+  frontier_push(&frontier, &s->final, 0);
+
+  //The heaps are ordered by value, which is only an upper
+  //bound of the mean for noisy objectives: hold visited 
+  //leaves back until nothing left unvisited could have a
+  //better mean.
+  struct topn_ready ready = {0};
+  int found = 0;
+  while (found < n && (frontier.count > 0 || ready.count > 0)) {
+    bool settled = ready.count > 0 && (
+      frontier.count == 0 ||
+      ready.heap[0]->mean >= cursor_node(&frontier.heap[0])->value
+    );
+    if (!settled) {
+      struct topn_cursor c = frontier_pop(&frontier);
+      const struct node *leaf = cursor_node(&c);
+      if (!leaf->pending && !leaf->estimated && !leaf->infeasible) {
+        ready_push(&ready, leaf);
+      }
+      continue;
+    }
+    const struct node *leaf = ready_pop(&ready);
+
+    struct clogo_optimum *o = &out[found];
+    calculate_center(leaf, o->point);
+    if (separate) {
+      if (!lattice_clear(&lattice, out, o->point)) continue;
+      int64_t cell[DIM];
+      lattice_cell(&lattice, o->point, cell);
+      int b = lattice_bucket(&lattice, cell);
+      lattice.next[found] = lattice.heads[b];
+      lattice.heads[b] = found;
+    }
+    o->value = leaf->mean;
+    o->depth = leaf->depth;
+    found++;
+  }
+
+  free(ready.heap);
+  free(frontier.heap);
+  free(lattice.heads);
+  free(lattice.next);
+  return found;
+} /* clogo_top_n() */
@@ -0,0 +1,94 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/trace.h"
+
+#include <math.h>
+#include <stdio.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* clogo_trace_init
+*
+* Initialize a trace to use an already opened file. The 
+* file isn't closed by the trace.
+***********************************************************/
+void clogo_trace_init(
+  struct clogo_trace *t,   //trace to initialize
+  FILE *file,              //file to write or read
+  enum clogo_trace_mode mode
+                           //record or replay
+)
+{
+  t->mode = mode;
+  t->file = file;
+  t->count = 0;
+  t->first_divergence = -1;
+} /* clogo_trace_init() */
+
+/***********************************************************
+* trace_replay
+*
+* Looks up the next sample of a replayed trace. If it 
+* matches the given fidelity level and point, its value is
+* stored in `value` and true is returned. Otherwise, or if
+* the replay already diverged, false is returned.
+***********************************************************/
+bool trace_replay(
+  struct clogo_trace *t,   //trace to read
+  int level,               //fidelity level being sampled
+  const double *point,     //point being sampled
+  double *value            //output recorded value
+)
+{
+  long idx = t->count++;
+  if (t->first_divergence >= 0) return false;
+
+  //Read the next record-- running off the end of the trace
+  //counts as a divergence as well.
+  int rec_level;
+  double rec_point[DIM];
+  bool match = fscanf(t->file, "%d", &rec_level) == 1;
+  for (int i = 0; i < DIM && match; i++) {
+    match = fscanf(t->file, "%la", &rec_point[i]) == 1;
+  }
+  double recorded = NAN;
+  match = match && fscanf(t->file, "%la", &recorded) == 1;
+
+  //Points have to match exactly, since a replayed run has 
+  //to make exactly the same decisions as the recorded one.
+  match = match && rec_level == level;
+  for (int i = 0; i < DIM && match; i++) {
+    match = rec_point[i] == point[i];
+  }
+
+  if (!match) {
+    t->first_divergence = idx;
+    fprintf(stderr, "trace: replay diverged at sample %ld, stopping\n", idx);
+    return false;
+  }
+  *value = recorded;
+  return true;
+} /* trace_replay() */
+
+/***********************************************************
+* trace_record
+*
+* Appends a sample to a recorded trace.
+***********************************************************/
+void trace_record(
+  struct clogo_trace *t,   //trace to write
+  int level,               //fidelity level sampled
+  const double *point,     //point sampled
+  double value             //value returned by the objective
+)
+{
+  t->count++;
+  fprintf(t->file, "%d", level);
+  for (int i = 0; i < DIM; i++) fprintf(t->file, " %a", point[i]);
+  fprintf(t->file, " %a\n", value);
+} /* trace_record() */
@@ -0,0 +1,186 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#include "clogo/vector.h"
+#include "clogo/table.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* vector_metrics
+*
+* Returns the metrics of a point, simulating it and adding
+* it to the store first if it isn't there yet.
+***********************************************************/
+static const double * vector_metrics(
+  const struct clogo_options *opt,
+                           //options holding the objective
+  struct clogo_vector_store *s,
+                           //store to search
+  double *point            //point to look up
+)
+{
+  size_t bytes = sizeof(*point) * s->dim;
+  struct vector_entry **bucket = &s->buckets[table_hash(point, bytes) % s->bucket_count];
+  for (struct vector_entry *e = *bucket; e != NULL; e = e->next) {
+    if (memcmp(e->data, point, bytes) == 0) {
+      s->hits++;
+      return &e->data[s->dim];
+    }
+  }
+
+  struct vector_entry *e = malloc(
+    sizeof(*e) + sizeof(*e->data) * (s->dim + s->metric_count)
+  );
+  memcpy(e->data, point, bytes);
+  (*opt->fn_vector)(point, &e->data[s->dim]);
+  e->next = *bucket;
+  *bucket = e;
+  s->evaluations++;
+  return &e->data[s->dim];
+} /* vector_metrics() */
+
+/***********************************************************
+* clogo_vector_store_init
+*
+* Initialize an empty store for points of `dim` entries and
+* `metric_count` metrics. The store never rehashes, so 
+* `bucket_count` should be in the order of the expected 
+* number of evaluations.
+***********************************************************/
+void clogo_vector_store_init(
+  struct clogo_vector_store *s,
+                           //store to initialize
+  int dim,                 //number of entries of a point
+  int metric_count,        //number of metrics per point
+  int bucket_count         //number of buckets
+)
+{
+  s->bucket_count = bucket_count;
+  s->buckets = calloc(bucket_count, sizeof(*s->buckets));
+  s->dim = dim;
+  s->metric_count = metric_count;
+  s->evaluations = 0;
+  s->hits = 0;
+} /* clogo_vector_store_init() */
+
+/***********************************************************
+* clogo_vector_store_delete
+*
+* Frees every entry of a store.
+***********************************************************/
+void clogo_vector_store_delete(
+  struct clogo_vector_store *s
+                           //store to delete
+)
+{
+  for (int i = 0; i < s->bucket_count; i++) {
+    struct vector_entry *e = s->buckets[i];
+    while (e != NULL) {
+      struct vector_entry *next = e->next;
+      free(e);
+      e = next;
+    }
+  }
+  free(s->buckets);
+  s->buckets = NULL;
+} /* clogo_vector_store_delete() */
+
+/***********************************************************
+* vector_evaluate
+*
+* Evaluates the weighted sum of the metrics of the vector-
+* valued objective at `count` inputs of `dim` entries, 
+* laid out one after the other. Metrics already in the 
+* options' store aren't simulated again.
+***********************************************************/
+void vector_evaluate(
+  const struct clogo_options *opt,
+                           //options holding the objective
+  double *inputs,          //inputs of the objective
+  int dim,                 //number of entries per input
+  int count,               //number of inputs
+  double *values           //output value of each input
+)
+{
+  double *scratch = NULL;
+  if (opt->store == NULL) scratch = malloc(sizeof(*scratch) * opt->metric_count);
+
+  for (int i = 0; i < count; i++) {
+    double *point = &inputs[i * dim];
+    const double *metrics = scratch;
+    if (opt->store != NULL) {
+      metrics = vector_metrics(opt, opt->store, point);
+    } else {
+      (*opt->fn_vector)(point, scratch);
+    }
+
+    values[i] = 0.0;
+    for (int m = 0; m < opt->metric_count; m++) {
+      values[i] += opt->weights[m] * metrics[m];
+    }
+  }
+
+  free(scratch);
+} /* vector_evaluate() */
+
+/***********************************************************
+* clogo_vector_optimize
+*
+* Runs one optimization per scalarization of the vector-
+* valued objective in `opt`, taking turns one step at a 
+* time. `weights` holds `count` rows of metric_count 
+* weights. The optimizations share a store, so every point
+* is simulated once and scored by each of them. `results` 
+* receives one result per scalarization; the number of 
+* points simulated is returned.
+***********************************************************/
+int64_t clogo_vector_optimize(
+  const struct clogo_options *opt,
+                           //options to run with
+  const double *weights,   //weights of each scalarization
+  int count,               //number of scalarizations
+  struct clogo_result *results
+                           //output result of each one
+)
+{
+  struct clogo_vector_store store;
+  int dim = opt->embed_dim > 0 ? opt->embed_dim : DIM;
+  clogo_vector_store_init(&store, dim, opt->metric_count, VECTOR_STORE_BUCKETS);
+
+  struct clogo_options *o = malloc(sizeof(*o) * count);
+  struct clogo_state *states = malloc(sizeof(*states) * count);
+  for (int i = 0; i < count; i++) {
+    o[i] = *opt;
+    o[i].weights = &weights[i * opt->metric_count];
+    o[i].store = &store;
+    states[i] = clogo_init(&o[i]);
+  }
+
+  //Taking turns keeps the trees at similar depths, so they
+  //keep asking for the same points.
+  for (bool running = true; running; ) {
+    running = false;
+    for (int i = 0; i < count; i++) {
+      if (clogo_done(&states[i])) continue;
+      clogo_step(&states[i]);
+      running = true;
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    results[i] = clogo_finish(&states[i]);
+    clogo_delete(&states[i]);
+  }
+  int64_t evaluations = store.evaluations;
+  clogo_vector_store_delete(&store);
+  free(states);
+  free(o);
+  return evaluations;
+} /* clogo_vector_optimize() */
@@ -0,0 +1,77 @@
+/*********************************************************************
+* INCLUDES
+*********************************************************************/
+#define _DEFAULT_SOURCE
+#include "clogo/clogo.h"
+#include "clogo/status.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/*********************************************************************
+* FUNCTIONS
+*********************************************************************/
+
+/***********************************************************
+* print_status
+*
+* Prints a snapshot on a single line.
+***********************************************************/
+static void print_status(
+  const struct clogo_status *s
+)
+{
+  printf("steps: %" PRId64 "\t samples: %" PRId64 "\t cost: %.1f\t w: %d\t"
+         " best: %.9g\t point:", s->steps, s->samples, s->cost, s->w,
+         s->best_value);
+  for (int i = 0; i < DIM; i++) printf(" %f", s->best_point[i]);
+  printf("\t depths:");
+  for (int h = 0; h < s->depth_count; h++) printf(" %" PRId64, s->depths[h]);
+  printf("\t final: %" PRId64 "%s\n", s->final, s->done ? "\t done" : "");
+} /* print_status() */
+
+/***********************************************************
+* main
+*
+* Prints the status an optimization publishes to the given
+* file (its `status_path`):
+*   clstatus PATH [--watch MS]
+* With --watch, prints a new line every MS milliseconds 
+* until the optimization is done.
+***********************************************************/
+int main(
+  int argc,
+  char **argv
+)
+{
+  long watch = 0;
+  if (argc == 4 && strcmp(argv[2], "--watch") == 0) {
+    watch = atol(argv[3]);
+  } else if (argc != 2) {
+    fprintf(stderr, "usage: %s PATH [--watch MS]\n", argv[0]);
+    return 1;
+  }
+
+  const struct clogo_status_page *page = clogo_status_map(argv[1]);
+  if (page == NULL) {
+    fprintf(stderr, "%s: no status page\n", argv[1]);
+    return 1;
+  }
+
+  struct clogo_status s;
+  clogo_status_read(page, &s);
+  print_status(&s);
+  while (watch > 0 && !s.done) {
+    struct timespec ts = {watch / 1000, (watch % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+    clogo_status_read(page, &s);
+    print_status(&s);
+  }
+
+  clogo_status_unmap(page);
+  return 0;
+} /* main() */